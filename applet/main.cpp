@@ -13,25 +13,22 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <actions.hpp>
 #include <payload.hpp>
 #include <util.hpp>
+#include "tui.hpp"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <string>
+#include <string_view>
 #include <switch.h>
+#include <thread>
 #include <vector>
 
 namespace {
 
-    typedef void (*TuiCallback)(void const *const user);
-
-    struct TuiItem {
-        std::string const text;
-        TuiCallback const cb;
-        void const *const user;
-        bool const selectable;
-    };
-
     void BootConfigCallback(void const *const user) {
         auto const config = reinterpret_cast<Payload::HekateConfig const *>(user);
 
@@ -44,10 +41,10 @@ namespace {
         Payload::RebootToHekateConfig(*config, true);
     }
 
-    void UmsCallback(void const *const user) {
-        Payload::RebootToHekateUMS(Payload::UmsTarget_Sd);
+    void ActionCallback(void const *const user) {
+        auto const action = reinterpret_cast<Payload::Action const *>(user);
 
-        (void)user;
+        Payload::Reboot(action->request);
     }
 
     void PayloadCallback(void const *const user) {
@@ -55,12 +52,36 @@ namespace {
 
         Payload::RebootToPayload(*config);
     }
+
+    /* Opens the software keyboard, returns false if it was cancelled. */
+    bool ReadQuery(std::string_view const current, char *const out, std::size_t const out_size) {
+        SwkbdConfig kbd;
+        if (R_FAILED(swkbdCreate(&kbd, 0)))
+            return false;
+
+        std::string const initial(current);
+
+        swkbdConfigMakePresetDefault(&kbd);
+        swkbdConfigSetGuideText(&kbd, "Search");
+        swkbdConfigSetInitialText(&kbd, initial.c_str());
+        swkbdConfigSetStringLenMax(&kbd, out_size - 1);
+
+        Result const rc = swkbdShow(&kbd, out, out_size);
+        swkbdClose(&kbd);
+
+        return R_SUCCEEDED(rc);
+    }
 }
 
 extern "C" void userAppInit(void) {
     spsmInitialize();
     splInitialize();
     i2cInitialize();
+
+    /* setsys is only needed for the capability probe. */
+    setsysInitialize();
+    util::ProbeCapabilities();
+    setsysExit();
 }
 
 extern "C" void userAppExit(void) {
@@ -84,62 +105,72 @@ int main(int const argc, char const *argv[]) {
         PadState pad;
         padInitializeAny(&pad);
 
+        Tui::Pacer pacer;
+
         while (appletMainLoop()) {
             /* Update padstate */
             padUpdate(&pad);
 
             if (padGetButtonsDown(&pad))
                 break;
+
+            pacer.Wait(false);
         }
 
         consoleExit(nullptr);
         return 0;
     }
 
-    std::vector<TuiItem> items;
+    Tui::Menu menu;
 
-    /* Load available boot configs */
-    auto const boot_config_list = Payload::LoadHekateConfigList();
+    util::StageProfile profile;
 
-    /* Load available ini configs */
-    auto const ini_config_list = Payload::LoadIniConfigList();
+    /* Load available boot and ini configs */
+    auto const configs = Payload::LoadBootConfigs();
+    auto const &boot_config_list = configs.boot;
+    auto const &ini_config_list = configs.ini;
+    profile.Mark("configs", boot_config_list.size() + ini_config_list.size());
 
     /* Load available payloads */
     auto const payload_config_list = Payload::LoadPayloadList();
+    profile.Mark("payloads", payload_config_list.size());
+
+    /* Count every header and entry up front, the menu is never resized. */
+    auto const section = [](std::size_t const count) -> std::size_t { return count ? 1 + count : 0; };
+    bool const show_payloads = util::IsErista();
+
+    std::size_t count = section(boot_config_list.size()) + section(ini_config_list.size());
+    for (auto const &group : Payload::ActionGroups())
+        count += 1 + std::count_if(group.actions.begin(), group.actions.end(), [](auto const &action) { return action.Available(); });
+    if (show_payloads)
+        count += section(payload_config_list.size());
 
     /* Build menu item list */
-    items.reserve(2 + boot_config_list.empty() ? 0 : 1 + boot_config_list.size()
-                    + ini_config_list.empty()  ? 0 : 1 + ini_config_list.size()
-                    + payload_config_list.empty()  ? 0 : 1 + payload_config_list.size());
+    menu.Reserve(count);
 
     if (!boot_config_list.empty()) {
-        items.emplace_back("quickReBoot to OS ->", nullptr, nullptr, false);
+        menu.AddHeader("quickReBoot to OS");
         for (auto const &entry : boot_config_list)
-            items.emplace_back(entry.name, BootConfigCallback, &entry, true);
+            menu.Add(entry.name, BootConfigCallback, &entry);
     }
 
     if (!ini_config_list.empty()) {
-        items.emplace_back("quickReBoot to INI ->", nullptr, nullptr, false);
+        menu.AddHeader("quickReBoot to INI");
         for (auto const &entry : ini_config_list)
-            items.emplace_back(entry.name, IniConfigCallback, &entry, true);
+            menu.Add(entry.name, IniConfigCallback, &entry);
     }
 
-    items.emplace_back("quickMount ->", nullptr, nullptr, false);
-    items.emplace_back("SD-Card -> UMS", UmsCallback, nullptr, true);
-
-    if (util::IsErista() && !payload_config_list.empty()) {
-        items.emplace_back("quickReBoot to Payload ->", nullptr, nullptr, false);
-        for (auto const &entry : payload_config_list)
-            items.emplace_back(entry.name, PayloadCallback, &entry, true);
+    for (auto const &group : Payload::ActionGroups()) {
+        menu.AddHeader(group.name);
+        for (auto const &action : group.actions)
+            if (action.Available())
+                menu.Add(action.name, ActionCallback, &action);
     }
 
-    std::size_t index = 0;
-
-    for (auto const &item : items) {
-        if (item.selectable)
-            break;
-
-        index++;
+    if (show_payloads && !payload_config_list.empty()) {
+        menu.AddHeader("quickReBoot to Payload");
+        for (auto const &entry : payload_config_list)
+            menu.Add(entry.name, PayloadCallback, &entry, entry.valid ? "" : "(invalid)");
     }
 
     PrintConsole *const console = consoleInit(nullptr);
@@ -154,75 +185,91 @@ int main(int const argc, char const *argv[]) {
     /* Deinit sm to free up our only service slot */
     smExit();
 
-    bool repaint = true;
+    /* Resolve the hekate payload while the menu is shown, only now that the service slot is free. */
+    std::thread preload(Payload::PreloadHekatePayload);
 
-    while (appletMainLoop()) {
-        {
-            /* Update padstate */
-            padUpdate(&pad);
+    /* The header never changes, only the list below it is redrawn. */
+    std::printf("  quickReBoot\n -------------\n");
 
-            u64 const kDown = padGetButtonsDown(&pad);
+#ifdef QRB_PROFILE
+    std::printf(" %s\n", profile.Format().c_str());
+#endif
 
-            if ((kDown & (HidNpadButton_Plus | HidNpadButton_B | HidNpadButton_L)))
-                break;
+#ifdef QRB_PROFILE
+    /* Wakeup and frame counters, refreshed together with the list so they cost no extra frame. */
+    std::size_t const stats_row = console->cursorY;
+    std::printf("\n");
 
-            if ((kDown & HidNpadButton_A)) {
-                auto &item = items[index];
+    util::Stopwatch uptime;
+    u64 frames = 0;
+#endif
 
-                if (item.selectable && item.cb)
-                    item.cb(item.user);
-            }
+    Tui::View view(console, console->cursorY);
+    Tui::Pacer pacer;
 
-            if ((kDown & HidNpadButton_Minus)) {
-                Payload::RebootToHekate();
-            }
+    while (appletMainLoop()) {
+        /* Update padstate */
+        padUpdate(&pad);
 
-            if ((kDown & HidNpadButton_AnyDown) && (index + 1) < items.size()) {
-                for (std::size_t i = index; i < items.size(); i++) {
-                    if (!items[i + 1].selectable)
-                        continue;
+        u64 const kDown = padGetButtonsDown(&pad);
 
-                    index = i + 1;
-                    break;
-                }
-                repaint = true;
-            }
+        if ((kDown & (HidNpadButton_Plus | HidNpadButton_B | HidNpadButton_L)))
+            break;
 
-            if ((kDown & HidNpadButton_AnyUp) && index > 0) {
-                for (std::size_t i = index; i > 0; i--) {
-                    if (!items[i - 1].selectable)
-                        continue;
+        if ((kDown & HidNpadButton_A)) {
+            auto const item = menu.Selected();
 
-                    index = i - 1;
-                    break;
-                }
-                repaint = true;
-            }
+            if (item != nullptr && item->cb)
+                item->cb(item->user);
         }
 
-        if (repaint) {
-            consoleClear();
-
-            std::printf("  quickReBoot\n -------------\n");
+        if ((kDown & HidNpadButton_Minus)) {
+            Payload::RebootToHekate();
+        }
 
-            for (std::size_t i = 0; i < items.size(); i++) {
-                auto const &item    = items[i];
-                bool const selected = (i == index);
+        if ((kDown & HidNpadButton_AnyDown))
+            menu.Move(1);
 
-                if (!item.selectable)
-                    console->flags |= CONSOLE_COLOR_FAINT;
+        if ((kDown & HidNpadButton_AnyUp))
+            menu.Move(-1);
 
-                std::printf("%s %s\n", selected ? "->" : "  ", item.text.c_str());
+        /* Search entries, extending the previous query only narrows its matches. */
+        if ((kDown & HidNpadButton_Y)) {
+            char query[0x40] = {};
 
-                if (!item.selectable)
-                    console->flags &= ~CONSOLE_COLOR_FAINT;
+            if (ReadQuery(menu.Query(), query, sizeof(query))) {
+                menu.Search(query);
+                view.Invalidate();
             }
-            repaint = false;
         }
 
-        consoleUpdate(nullptr);
+        /* Page through long lists. */
+        if ((kDown & HidNpadButton_AnyRight))
+            menu.Move(view.Rows());
+
+        if ((kDown & HidNpadButton_AnyLeft))
+            menu.Move(-static_cast<std::ptrdiff_t>(view.Rows()));
+
+        view.Draw(menu.Items(), menu.Index());
+
+#ifdef QRB_PROFILE
+        if (view.Dirty()) {
+            frames++;
+            std::printf("\x1b[%zu;1H\x1b[2K %llu wakeups, %llu frames in %llums", stats_row + 1,
+                        static_cast<unsigned long long>(pacer.Wakeups()), static_cast<unsigned long long>(frames),
+                        static_cast<unsigned long long>(uptime.ElapsedUs() / 1000));
+        }
+#endif
+
+        bool const drawn = view.Present();
+
+        /* Sleep until the next input poll instead of spinning. */
+        pacer.Wait(kDown != 0 || drawn);
     }
 
+    preload.join();
+    Payload::ClosePreloadSession();
+
     consoleExit(nullptr);
 
     (void)argc;
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tui.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Tui {
+
+    void Menu::Reserve(std::size_t const count) {
+        entries.reserve(count);
+        items.reserve(count + 1);
+        selectable.reserve(count);
+        filter.Reserve(count, 0);
+    }
+
+    void Menu::AddHeader(std::string_view const text) {
+        entries.emplace_back(text, nullptr, nullptr, false);
+        items.push_back(entries.back());
+    }
+
+    void Menu::Add(std::string_view const text, Callback const cb, void const *const user, std::string_view const note) {
+        filter.Add(text);
+        entries.emplace_back(text, cb, user, true, note);
+
+        selectable.push_back(items.size());
+        items.push_back(entries.back());
+    }
+
+    void Menu::Search(std::string_view const query) {
+        filter.Set(query);
+        Show();
+    }
+
+    void Menu::Show() {
+        items.clear();
+        selectable.clear();
+        cursor = 0;
+
+        if (!filter.Query().empty())
+            items.emplace_back("search", nullptr, nullptr, false, filter.Query());
+
+        /* Filter ids count the selectable entries in order. */
+        auto match = filter.Matches().begin();
+        auto const end = filter.Matches().end();
+        Item const *header = nullptr;
+        std::uint32_t id = 0;
+
+        for (auto const &entry : entries) {
+            if (!entry.selectable) {
+                header = &entry;
+                continue;
+            }
+
+            if (match != end && *match == id) {
+                /* Show a header only above its first match. */
+                if (header != nullptr) {
+                    items.push_back(*header);
+                    header = nullptr;
+                }
+
+                selectable.push_back(items.size());
+                items.push_back(entry);
+                ++match;
+            }
+
+            id++;
+        }
+    }
+
+    void Menu::Move(std::ptrdiff_t const delta) {
+        if (selectable.empty())
+            return;
+
+        std::ptrdiff_t const last = selectable.size() - 1;
+        cursor = std::clamp<std::ptrdiff_t>(cursor + delta, 0, last);
+    }
+
+    void Pacer::Wait(bool const active) {
+        constexpr u64 FrameNs   = 16'666'666;
+        constexpr u64 IdleNs    = 2 * FrameNs;
+        constexpr std::size_t IdleFrames = 60;
+
+        idle_frames = active ? 0 : idle_frames + 1;
+
+        /* Returns early for applet messages, appletMainLoop handles them. */
+        eventWait(appletGetMessageEvent(), idle_frames < IdleFrames ? FrameNs : IdleNs);
+        wakeups++;
+    }
+
+    View::View(PrintConsole *const console, std::size_t const first_row)
+        : console(console), first_row(first_row), rows(std::max<int>(console->consoleHeight - static_cast<int>(first_row) - 1, 1)) {
+    }
+
+    void View::MoveTo(std::size_t const row, std::size_t const column) const {
+        /* ANSI positions are 1-based. */
+        std::printf("\x1b[%zu;%zuH", first_row + row + 1, column + 1);
+    }
+
+    void View::DrawMarker(std::size_t const row, bool const selected) {
+        MoveTo(row, 0);
+        std::printf("%s", selected ? "->" : "  ");
+        dirty = true;
+    }
+
+    void View::DrawRow(std::size_t const row, Item const *const item, bool const selected) {
+        MoveTo(row, 0);
+        std::printf("\x1b[2K");
+        dirty = true;
+
+        if (item == nullptr)
+            return;
+
+        /* Section headers are marked with a trailing arrow. Never touch the */
+        /* last column, the console would wrap and scroll. */
+        int const width = console->consoleWidth - 1;
+        char line[0x100];
+        std::snprintf(line, sizeof(line), "%s %.*s%s %.*s", selected ? "->" : "  ",
+                      static_cast<int>(item->text.size()), item->text.data(), item->selectable ? "" : " ->",
+                      static_cast<int>(item->note.size()), item->note.data());
+
+        if (!item->selectable)
+            console->flags |= CONSOLE_COLOR_FAINT;
+
+        std::printf("%.*s", width, line);
+
+        if (!item->selectable)
+            console->flags &= ~CONSOLE_COLOR_FAINT;
+    }
+
+    void View::Draw(std::span<Item const> const items, std::size_t const index) {
+        /* Scroll the selection into the window, keeping its section header visible. */
+        if (index < top) {
+            top = (index > 0 && !items[index - 1].selectable) ? index - 1 : index;
+            stale = true;
+        } else if (index >= top + rows) {
+            top = index + 1 - rows;
+            stale = true;
+        }
+
+        if (stale) {
+            for (std::size_t row = 0; row < rows; row++) {
+                std::size_t const i = top + row;
+                DrawRow(row, i < items.size() ? &items[i] : nullptr, i == index);
+            }
+
+            stale = false;
+        } else if (drawn != index) {
+            if (drawn >= top && drawn < top + rows)
+                DrawMarker(drawn - top, false);
+
+            DrawMarker(index - top, true);
+        }
+
+        drawn = index;
+    }
+
+    bool View::Present() {
+        if (!dirty)
+            return false;
+
+        consoleUpdate(console);
+        dirty = false;
+
+        return true;
+    }
+
+}
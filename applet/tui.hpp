@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <name_filter.hpp>
+
+#include <switch.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Tui {
+
+    typedef void (*Callback)(void const *const user);
+
+    struct Item {
+        std::string_view const text;
+        Callback const cb;
+        void const *const user;
+        bool const selectable;
+        std::string_view const note = {};
+    };
+
+    /**
+     * Menu items plus the positions of the selectable ones, so moving the
+     * selection by a row or a page is a single index step. A search shows
+     * only the matching entries below their section headers.
+     */
+    class Menu {
+      private:
+        std::vector<Item> entries;
+        util::NameFilter filter;
+
+        std::vector<Item> items;
+        std::vector<std::size_t> selectable;
+        std::size_t cursor = 0;
+
+        void Show();
+
+      public:
+        void Reserve(std::size_t const count);
+        void AddHeader(std::string_view const text);
+        void Add(std::string_view const text, Callback const cb, void const *const user, std::string_view const note = {});
+
+        /* Empty query shows every entry again. */
+        void Search(std::string_view const query);
+
+        std::string_view Query() const {
+            return filter.Query();
+        }
+
+        std::span<Item const> Items() const {
+            return items;
+        }
+
+        /* Item index of the selection, 0 if nothing is selectable. */
+        std::size_t Index() const {
+            return selectable.empty() ? 0 : selectable[cursor];
+        }
+
+        Item const *Selected() const {
+            return selectable.empty() ? nullptr : &items[selectable[cursor]];
+        }
+
+        /* Moves by delta selectable items, clamped to the first and last one. */
+        void Move(std::ptrdiff_t const delta);
+    };
+
+    /**
+     * Paces the main loop. HID has no event for button presses, so the loop
+     * sleeps on the applet message event with a frame long timeout while the
+     * menu is in use and backs off once it sat idle for a second.
+     */
+    class Pacer {
+      private:
+        std::size_t idle_frames = 0;
+        u64 wakeups = 0;
+
+      public:
+        /* active: input was handled or something was drawn this iteration. */
+        void Wait(bool const active);
+
+        u64 Wakeups() const {
+            return wakeups;
+        }
+    };
+
+    /**
+     * Retained view of the item list below a fixed header. A cursor move only
+     * rewrites the two selection markers, the window is redrawn when it scrolls
+     * and the framebuffer is only flushed after something was drawn.
+     */
+    class View {
+      private:
+        PrintConsole *const console;
+        std::size_t const first_row;
+        std::size_t const rows;
+
+        std::size_t top = 0;
+        std::size_t drawn = SIZE_MAX;
+        bool stale = true;
+        bool dirty = true;
+
+        void MoveTo(std::size_t const row, std::size_t const column) const;
+        void DrawMarker(std::size_t const row, bool const selected);
+        void DrawRow(std::size_t const row, Item const *const item, bool const selected);
+
+      public:
+        View(PrintConsole *const console, std::size_t const first_row);
+
+        /* Redraws the whole window, e.g. after the item list changed. */
+        void Invalidate() {
+            top   = 0;
+            stale = true;
+        }
+
+        std::size_t Rows() const {
+            return rows;
+        }
+
+        void Draw(std::span<Item const> const items, std::size_t const index);
+
+        bool Dirty() const {
+            return dirty;
+        }
+
+        /* Returns false if there was nothing to flush. */
+        bool Present();
+    };
+
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "actions.hpp"
+#include "util.hpp"
+
+#include <array>
+
+namespace Payload {
+
+    namespace {
+
+        constexpr std::array UmsActions = {
+            Action { "SD-Card",      BootRequest::Ums(UmsTarget_Sd) },
+            Action { "eMMC BOOT0",   BootRequest::Ums(UmsTarget_NandBoot0) },
+            Action { "eMMC BOOT1",   BootRequest::Ums(UmsTarget_NandBoot1) },
+            Action { "eMMC GPP",     BootRequest::Ums(UmsTarget_Nand) },
+            Action { "emuMMC BOOT0", BootRequest::Ums(UmsTarget_EmuMMCBoot0) },
+            Action { "emuMMC BOOT1", BootRequest::Ums(UmsTarget_EmuMMCBoot1) },
+            Action { "emuMMC GPP",   BootRequest::Ums(UmsTarget_EmuMMC) },
+        };
+
+        constexpr std::array RebootActions = {
+            Action { "hekate",        BootRequest::Hekate() },
+            Action { "hekate Menu",   BootRequest::Menu() },
+            Action { "Recovery Mode", BootRequest::Recovery() },
+            Action { "Panic",         BootRequest::Panic() },
+        };
+
+        constexpr std::array Groups = {
+            ActionGroup { "quickMount", UmsActions },
+            ActionGroup { "quickReBoot to hekate", RebootActions },
+        };
+
+    }
+
+    bool Action::Available() const {
+        return !util::IsErista() || request.SupportsErista();
+    }
+
+    std::span<ActionGroup const> ActionGroups() {
+        return Groups;
+    }
+
+}
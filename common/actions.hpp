@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "boot_request.hpp"
+
+#include <span>
+#include <string_view>
+
+namespace Payload {
+
+    /* A fixed hekate reboot offered by both frontends. */
+    struct Action {
+        std::string_view name;
+        BootRequest request;
+
+        /* Recovery and panic reboots can only be requested through the RTC on mariko. */
+        bool Available() const;
+    };
+
+    struct ActionGroup {
+        std::string_view name;
+        std::span<Action const> actions;
+    };
+
+    /* Menu sections in display order, new actions only need an entry here. */
+    std::span<ActionGroup const> ActionGroups();
+
+}
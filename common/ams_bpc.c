@@ -15,13 +15,16 @@
  */
 #include <switch.h>
 #include "ams_bpc.h"
+#include "trace.h"
 
 static Service g_amsBpcSrv;
 
 Result amsBpcInitialize(void) {
+    u32 span = traceBegin(TraceStage_AmsBpcInitialize);
     Handle h;
     Result rc = svcConnectToNamedPort(&h, "bpc:ams"); /* TODO: ams:bpc */
     if (R_SUCCEEDED(rc)) serviceCreate(&g_amsBpcSrv, h);
+    traceEnd(span);
     return rc;
 }
 
@@ -34,8 +37,11 @@ Service *amsBpcGetServiceSession(void) {
 }
 
 Result amsBpcSetRebootPayload(const void *src, size_t src_size) {
-    return serviceDispatch(&g_amsBpcSrv, 65001,
+    u32 span = traceBegin(TraceStage_AmsBpcSetRebootPayload);
+    Result rc = serviceDispatch(&g_amsBpcSrv, 65001,
         .buffer_attrs = { SfBufferAttr_In | SfBufferAttr_HipcMapAlias },
         .buffers = { { src, src_size } },
     );
+    traceEnd(span);
+    return rc;
 }
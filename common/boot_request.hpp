@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "rtc_r2p.hpp"
+
+#include <switch.h>
+#include <cstddef>
+
+namespace Payload {
+
+    enum BootCfg {
+        BootCfg_ForceAutoBoot = 1 << 0,
+        BootCfg_ShowLaunchLog = 1 << 1,
+        BootCfg_BootFromId    = 1 << 2,
+        BootCfg_BootToEmuMMC  = 1 << 3,
+        BootCfg_SeptRun       = 1 << 7,
+    };
+
+    enum ExtraCfg {
+        ExtraCfg_Keys      = 1 << 0,
+        ExtraCfg_Payload   = 1 << 1,
+        ExtraCfg_Module    = 1 << 2,
+        ExtraCfg_NyxBis    = 1 << 4,
+        ExtraCfg_NyxUms    = 1 << 5,
+        ExtraCfg_NyxReload = 1 << 6,
+        ExtraCfg_NyxDump   = 1 << 7,
+    };
+
+    enum UmsTarget {
+        UmsTarget_Sd,
+        UmsTarget_NandBoot0,
+        UmsTarget_NandBoot1,
+        UmsTarget_Nand,
+        UmsTarget_EmuMMCBoot0,
+        UmsTarget_EmuMMCBoot1,
+        UmsTarget_EmuMMC,
+    };
+
+    // clang-format off
+    struct BootStorage {
+        /* 0x94 */  u8 boot_cfg;
+        /* 0x95 */  u8 autoboot;
+        /* 0x96 */  u8 autoboot_list;
+        /* 0x97 */  u8 extra_cfg;
+        /* 0x98 */  union {
+        /*      */      struct {
+        /* 0x98 */          char id[8];
+        /* 0xA0 */          char emummc_path[0x78];
+        /*      */      };
+        /* 0x98 */      u8 ums;
+        /* 0x98 */      u8 xt_str[0x80];
+        /*      */  };
+    };
+    // clang-format on
+
+    static_assert(sizeof(BootStorage) == 0x84, "Boot storage size!");
+    static_assert(offsetof(BootStorage, extra_cfg) == 0x97 - 0x94, "Boot storage layout!");
+    static_assert(offsetof(BootStorage, ums) == 0x98 - 0x94, "Boot storage layout!");
+    static_assert(offsetof(BootStorage, emummc_path) == 0xA0 - 0x94, "Boot storage layout!");
+    static_assert(sizeof(Max77620Rtc::rtc_reboot_reason_t) == sizeof(u16), "RTC reboot reason size!");
+
+    /**
+     * One hekate reboot request. Encodes to the boot storage of the hekate payload
+     * on erista and to the RTC alarm registers read by hekate on mariko.
+     */
+    struct BootRequest {
+        u8 reason;        /* Max77620Rtc::REBOOT_REASON_* */
+        u8 autoboot;      /* 1-based entry index for REBOOT_REASON_SELF. */
+        bool autoboot_list;
+        u8 ums;           /* UmsTarget for REBOOT_REASON_UMS. */
+
+        static constexpr BootRequest Hekate() {
+            return { .reason = Max77620Rtc::REBOOT_REASON_NOP };
+        }
+
+        static constexpr BootRequest Config(std::size_t const index, bool const list) {
+            return { .reason = Max77620Rtc::REBOOT_REASON_SELF, .autoboot = static_cast<u8>(index), .autoboot_list = list };
+        }
+
+        static constexpr BootRequest Menu() {
+            return { .reason = Max77620Rtc::REBOOT_REASON_MENU };
+        }
+
+        static constexpr BootRequest Ums(UmsTarget const target) {
+            return { .reason = Max77620Rtc::REBOOT_REASON_UMS, .ums = static_cast<u8>(target) };
+        }
+
+        static constexpr BootRequest Recovery() {
+            return { .reason = Max77620Rtc::REBOOT_REASON_REC };
+        }
+
+        static constexpr BootRequest Panic() {
+            return { .reason = Max77620Rtc::REBOOT_REASON_PANIC };
+        }
+
+        /* Recovery and panic only exist as RTC reasons. */
+        constexpr bool SupportsErista() const {
+            return reason <= Max77620Rtc::REBOOT_REASON_UMS;
+        }
+
+        constexpr BootStorage ToBootStorage() const {
+            BootStorage storage = {};
+
+            switch (reason) {
+                case Max77620Rtc::REBOOT_REASON_SELF:
+                    /* Force autoboot and set boot id. */
+                    storage.boot_cfg      = BootCfg_ForceAutoBoot;
+                    storage.autoboot      = autoboot;
+                    storage.autoboot_list = autoboot_list;
+                    break;
+                case Max77620Rtc::REBOOT_REASON_MENU:
+                    /* Force boot to menu */
+                    storage.boot_cfg = BootCfg_ForceAutoBoot;
+                    storage.autoboot = 0;
+                    break;
+                case Max77620Rtc::REBOOT_REASON_UMS:
+                    /* Force boot to menu, target UMS and select target. */
+                    storage.boot_cfg  = BootCfg_ForceAutoBoot;
+                    storage.extra_cfg = ExtraCfg_NyxUms;
+                    storage.autoboot  = 0;
+                    storage.ums       = ums;
+                    break;
+                default:
+                    break;
+            }
+
+            return storage;
+        }
+
+        /* Same bit layout as Max77620Rtc::rtc_rr_decoded_t, split into the two 6-bit registers. */
+        constexpr u16 ToRtcDecoded() const {
+            return (reason & 0xf) | ((autoboot & 0xf) << 4) | ((autoboot_list ? 1 : 0) << 8) | ((ums & 0x7) << 9);
+        }
+
+        constexpr u8 ToRtcVal1() const {
+            return ToRtcDecoded() & 0x3f;
+        }
+
+        constexpr u8 ToRtcVal2() const {
+            return (ToRtcDecoded() >> 6) & 0x3f;
+        }
+
+        Max77620Rtc::rtc_reboot_reason_t ToRtc() const {
+            return { .enc = { .val1 = ToRtcVal1(), .val2 = ToRtcVal2() } };
+        }
+    };
+
+    /* Encodings checked against hekate's boot_cfg_t and rtc_reboot_reason_t. */
+    static_assert(BootRequest::Hekate().ToRtcVal1() == 0x00 && BootRequest::Hekate().ToRtcVal2() == 0x00);
+    static_assert(BootRequest::Menu().ToRtcVal1() == 0x02 && BootRequest::Menu().ToRtcVal2() == 0x00);
+    static_assert(BootRequest::Config(5, true).ToRtcVal1() == 0x11 && BootRequest::Config(5, true).ToRtcVal2() == 0x05);
+    static_assert(BootRequest::Config(0x13, false).ToRtcVal1() == 0x31 && BootRequest::Config(0x13, false).ToRtcVal2() == 0x00);
+    static_assert(BootRequest::Ums(UmsTarget_EmuMMC).ToRtcVal1() == 0x03 && BootRequest::Ums(UmsTarget_EmuMMC).ToRtcVal2() == 0x30);
+    static_assert(BootRequest::Recovery().ToRtcVal1() == 0x04 && BootRequest::Panic().ToRtcVal1() == 0x05);
+    static_assert(BootRequest::Hekate().ToBootStorage().boot_cfg == 0);
+    static_assert(BootRequest::Config(3, true).ToBootStorage().autoboot == 3 && BootRequest::Config(3, true).ToBootStorage().autoboot_list == 1);
+    static_assert(BootRequest::Ums(UmsTarget_NandBoot1).ToBootStorage().extra_cfg == ExtraCfg_NyxUms && BootRequest::Ums(UmsTarget_NandBoot1).ToBootStorage().ums == 2);
+    static_assert(BootRequest::Menu().ToBootStorage().boot_cfg == BootCfg_ForceAutoBoot && BootRequest::Menu().ToBootStorage().autoboot == 0);
+    static_assert(!BootRequest::Recovery().SupportsErista() && BootRequest::Ums(UmsTarget_Sd).SupportsErista());
+
+}
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "config_index.hpp"
+
+#include <sys/stat.h>
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+namespace Payload::Index {
+
+    namespace {
+
+        constexpr u32 IndexMagic   = 0x49425251; /* QRBI */
+        constexpr u32 IndexVersion = 3;
+
+        constexpr u32 RegistryMagic   = 0x50425251; /* QRBP */
+        constexpr u32 RegistryVersion = 1;
+
+        /* Upper bound for the index size, anything larger is treated as corrupted. */
+        constexpr s64 IndexMaxSize = 0x100000;
+
+        class Writer {
+          private:
+            std::vector<u8> buffer;
+
+          public:
+            template<typename T>
+            void Put(T const value) {
+                auto const bytes = reinterpret_cast<u8 const *>(&value);
+                buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+            }
+
+            void PutString(std::string_view const str) {
+                Put(static_cast<u16>(str.size()));
+                buffer.insert(buffer.end(), str.begin(), str.end());
+            }
+
+            std::span<u8 const> Data() const {
+                return buffer;
+            }
+        };
+
+        class Reader {
+          private:
+            std::span<u8 const> const data;
+            std::size_t offset = 0;
+            bool ok = true;
+
+          public:
+            explicit Reader(std::span<u8 const> const data) : data(data) { }
+
+            template<typename T>
+            T Get() {
+                T value = {};
+
+                if (!ok || offset + sizeof(T) > data.size()) {
+                    ok = false;
+                    return value;
+                }
+
+                std::memcpy(&value, data.data() + offset, sizeof(T));
+                offset += sizeof(T);
+
+                return value;
+            }
+
+            std::string_view GetString() {
+                auto const size = Get<u16>();
+
+                if (!ok || offset + size > data.size()) {
+                    ok = false;
+                    return {};
+                }
+
+                std::string_view const str(reinterpret_cast<char const *>(data.data() + offset), size);
+                offset += size;
+
+                return str;
+            }
+
+            bool Ok() const {
+                return ok;
+            }
+
+            std::size_t Remaining() const {
+                return data.size() - offset;
+            }
+
+            bool AtEnd() const {
+                return ok && offset == data.size();
+            }
+        };
+
+        std::vector<u8> ReadIndexFile(char const *path) {
+            struct stat st;
+            if (stat(path, &st) != 0 || st.st_size <= 0 || st.st_size > IndexMaxSize)
+                return {};
+
+            /* Read the whole index at once. */
+            auto const file = fopen(path, "rb");
+            if (file == nullptr)
+                return {};
+
+            std::vector<u8> data(st.st_size);
+            auto const ret = fread(data.data(), 1, data.size(), file);
+
+            fclose(file);
+
+            if (ret != data.size())
+                return {};
+
+            return data;
+        }
+
+        bool WriteIndexFile(char const *path, std::span<u8 const> const data) {
+            auto const file = fopen(path, "wb");
+            if (file == nullptr)
+                return false;
+
+            auto const ret = fwrite(data.data(), 1, data.size(), file);
+
+            fclose(file);
+
+            /* Don't leave a truncated index behind. */
+            if (ret != data.size()) {
+                remove(path);
+                return false;
+            }
+
+            return true;
+        }
+
+        void PutSource(Writer &writer, Source const &source) {
+            writer.PutString(source.path);
+            writer.Put(source.mtime);
+            writer.Put(source.size);
+        }
+
+        Source GetSource(Reader &reader) {
+            auto const path  = reader.GetString();
+            auto const mtime = reader.Get<s64>();
+            auto const size  = reader.Get<s64>();
+
+            return { std::string(path), mtime, size };
+        }
+
+        void PutConfigs(Writer &writer, HekateConfigList const &list) {
+            writer.Put(static_cast<u32>(list.size()));
+
+            for (auto const &config : list) {
+                writer.PutString(config.name);
+                writer.Put(static_cast<u32>(config.index));
+                writer.PutString(config.source);
+                writer.Put(static_cast<u32>(config.offset));
+            }
+        }
+
+        bool GetConfigs(Reader &reader, HekateConfigList &list) {
+            auto const count = reader.Get<u32>();
+
+            /* An entry takes at least twelve bytes, don't trust count beyond that. */
+            list.Reserve(std::min<std::size_t>(count, reader.Remaining() / 12), reader.Remaining());
+
+            std::string_view source;
+
+            for (u32 i = 0; i < count && reader.Ok(); i++) {
+                auto const name        = reader.GetString();
+                auto const index       = reader.Get<u32>();
+                auto const source_path = reader.GetString();
+                auto const offset      = reader.Get<u32>();
+
+                if (!reader.Ok())
+                    break;
+
+                /* Entries of the same file share the interned path. The buffer was reserved */
+                /* for the remaining index size, so it never moves while loading. */
+                if (source != source_path)
+                    source = list.Intern(source_path);
+
+                auto const interned = list.Intern(name);
+                list.Push({ .name = interned, .index = index, .source = source, .offset = offset });
+            }
+
+            return reader.Ok();
+        }
+
+    }
+
+    Stamp Stat(char const *path) {
+        struct stat st;
+
+        if (stat(path, &st) != 0)
+            return { -1, -1 };
+
+        return { static_cast<s64>(st.st_mtime), static_cast<s64>(st.st_size) };
+    }
+
+    Source Fingerprint(char const *path) {
+        auto const stamp = Stat(path);
+        return { path, stamp.mtime, stamp.size };
+    }
+
+    std::optional<BootConfigs> Load(char const *path, SourceList const &sources) {
+        auto const data = ReadIndexFile(path);
+        if (data.empty())
+            return std::nullopt;
+
+        Reader reader(data);
+
+        if (reader.Get<u32>() != IndexMagic || reader.Get<u32>() != IndexVersion)
+            return std::nullopt;
+
+        /* The index is only valid for the exact same set of unchanged sources. */
+        if (reader.Get<u32>() != sources.size())
+            return std::nullopt;
+
+        for (auto const &source : sources) {
+            auto const source_path = reader.GetString();
+            auto const mtime       = reader.Get<s64>();
+            auto const size        = reader.Get<s64>();
+
+            if (!reader.Ok() || source_path != source.path || mtime != source.mtime || size != source.size)
+                return std::nullopt;
+        }
+
+        BootConfigs configs;
+
+        if (!GetConfigs(reader, configs.boot) || !GetConfigs(reader, configs.ini) || !reader.AtEnd())
+            return std::nullopt;
+
+        return configs;
+    }
+
+    bool Store(char const *path, SourceList const &sources, BootConfigs const &configs) {
+        Writer writer;
+
+        writer.Put(IndexMagic);
+        writer.Put(IndexVersion);
+
+        writer.Put(static_cast<u32>(sources.size()));
+        for (auto const &source : sources)
+            PutSource(writer, source);
+
+        PutConfigs(writer, configs.boot);
+        PutConfigs(writer, configs.ini);
+
+        return WriteIndexFile(path, writer.Data());
+    }
+
+    PayloadRegistry LoadPayloadRegistry(char const *path) {
+        auto const data = ReadIndexFile(path);
+        Reader reader(data);
+
+        if (reader.Get<u32>() != RegistryMagic || reader.Get<u32>() != RegistryVersion)
+            return {};
+
+        auto const count = reader.Get<u32>();
+
+        /* A record takes at least 22 bytes, don't trust count beyond that. */
+        PayloadRegistry registry;
+        registry.reserve(std::min<std::size_t>(count, reader.Remaining() / 22));
+
+        for (u32 i = 0; i < count && reader.Ok(); i++) {
+            auto source    = GetSource(reader);
+            auto const crc = reader.Get<u32>();
+
+            if (reader.Ok())
+                registry.push_back({ std::move(source), crc });
+        }
+
+        if (!reader.AtEnd() || !std::is_sorted(registry.begin(), registry.end(), [](auto const &lhs, auto const &rhs) { return lhs.source.path < rhs.source.path; }))
+            return {};
+
+        return registry;
+    }
+
+    bool StorePayloadRegistry(char const *path, PayloadRegistry const &registry) {
+        Writer writer;
+
+        writer.Put(RegistryMagic);
+        writer.Put(RegistryVersion);
+
+        writer.Put(static_cast<u32>(registry.size()));
+        for (auto const &record : registry) {
+            PutSource(writer, record.source);
+            writer.Put(record.crc);
+        }
+
+        return WriteIndexFile(path, writer.Data());
+    }
+
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "payload.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Payload::Index {
+
+    /**
+     * Modification time and size of a file, enough to tell whether it changed.
+     * Files which don't exist are recorded with mtime and size of -1.
+     */
+    struct Stamp {
+        s64 mtime;
+        s64 size;
+
+        bool operator==(Stamp const &) const = default;
+    };
+
+    /* Fingerprint of a file the boot configs were parsed from. */
+    struct Source {
+        std::string path;
+        s64 mtime;
+        s64 size;
+
+        Stamp GetStamp() const {
+            return { mtime, size };
+        }
+
+        bool operator==(Source const &) const = default;
+    };
+
+    using SourceList = std::vector<Source>;
+
+    /* Doesn't copy the path, for checking files against recorded sources. */
+    Stamp Stat(char const *path);
+    Source Fingerprint(char const *path);
+
+    /* Returns the cached configs if the index was built from exactly these sources. */
+    std::optional<BootConfigs> Load(char const *path, SourceList const &sources);
+    bool Store(char const *path, SourceList const &sources, BootConfigs const &configs);
+
+    /* Checksum of a payload file, valid as long as the file's fingerprint matches. */
+    struct PayloadRecord {
+        Source source;
+        u32 crc;
+
+        bool operator==(PayloadRecord const &) const = default;
+    };
+
+    /* Sorted by path. */
+    using PayloadRegistry = std::vector<PayloadRecord>;
+
+    PayloadRegistry LoadPayloadRegistry(char const *path);
+    bool StorePayloadRegistry(char const *path, PayloadRegistry const &registry);
+
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Payload {
+
+    /**
+     * Contiguous list of config entries whose strings are interned into one shared buffer.
+     * T lists its std::string_view members in T::Strings so they can be moved along when
+     * the buffer grows. Entry addresses stay valid until the list is modified.
+     */
+    template<typename T>
+    class ConfigList {
+      private:
+        std::vector<char> arena;
+        std::vector<T> entries;
+
+        void Grow(std::size_t const required) {
+            std::vector<char> grown;
+            grown.reserve(std::max(required, arena.capacity() * 2));
+            grown.assign(arena.begin(), arena.end());
+
+            /* Point all strings into the new buffer. */
+            for (auto &entry : entries) {
+                for (auto const member : T::Strings) {
+                    auto &str = entry.*member;
+                    str = { grown.data() + (str.data() - arena.data()), str.size() };
+                }
+            }
+
+            arena = std::move(grown);
+        }
+
+      public:
+        ConfigList() = default;
+        ConfigList(ConfigList &&) = default;
+        ConfigList &operator=(ConfigList &&) = default;
+
+        /* Copies would point into the source buffer. */
+        ConfigList(ConfigList const &) = delete;
+        ConfigList &operator=(ConfigList const &) = delete;
+
+        /* Grows geometrically, so reserving once per parsed file stays amortized. */
+        void Reserve(std::size_t const count, std::size_t const string_bytes) {
+            if (count > entries.capacity())
+                entries.reserve(std::max(count, entries.capacity() * 2));
+
+            if (string_bytes > arena.capacity())
+                Grow(string_bytes);
+        }
+
+        /* Copies str into the buffer. The result is null terminated. */
+        std::string_view Intern(std::string_view const str) {
+            if (arena.size() + str.size() + 1 > arena.capacity())
+                Grow(arena.size() + str.size() + 1);
+
+            auto const offset = arena.size();
+            arena.insert(arena.end(), str.begin(), str.end());
+            arena.push_back('\0');
+
+            return { arena.data() + offset, str.size() };
+        }
+
+        /* Strings of entry must have been interned into this list. */
+        T &Push(T &&entry) {
+            return entries.emplace_back(std::move(entry));
+        }
+
+        std::size_t StringSize() const {
+            return arena.size();
+        }
+
+        auto begin() const { return entries.begin(); }
+        auto end() const { return entries.end(); }
+        std::size_t size() const { return entries.size(); }
+        bool empty() const { return entries.empty(); }
+    };
+
+}
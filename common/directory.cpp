@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "directory.hpp"
+
+#include <dirent.h>
+#include <strings.h>
+#include <algorithm>
+#include <cstring>
+
+namespace util {
+
+    namespace {
+
+        bool HasExtension(char const *name, std::size_t const length, std::string_view const extension) {
+            if (length <= extension.size())
+                return extension.empty() && length != 0;
+
+            return strncasecmp(name + length - extension.size(), extension.data(), extension.size()) == 0;
+        }
+
+    }
+
+    DirectoryListing::DirectoryListing(char const *path, std::string_view const extension) {
+        auto const dirp = opendir(path);
+        if (dirp == nullptr)
+            return;
+
+        /* Offsets instead of views while the buffer may still grow. */
+        std::vector<std::size_t> offsets;
+
+        while (auto const dent = readdir(dirp)) {
+            if (dent->d_type != DT_REG)
+                continue;
+
+            auto const length = std::strlen(dent->d_name);
+            if (!HasExtension(dent->d_name, length, extension))
+                continue;
+
+            offsets.push_back(buffer.size());
+            buffer.insert(buffer.end(), dent->d_name, dent->d_name + length + 1);
+        }
+
+        closedir(dirp);
+
+        names.reserve(offsets.size());
+        for (auto const offset : offsets)
+            names.emplace_back(buffer.data() + offset);
+
+        /* Order by ASCII, like hekate does. */
+        std::sort(names.begin(), names.end());
+    }
+
+}
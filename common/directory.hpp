@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+    /**
+     * Sorted names of the regular files in a directory. Works on absolute paths only and
+     * never touches the working directory, so it may be used from any thread.
+     * Names are stored null terminated in one buffer.
+     */
+    class DirectoryListing {
+      private:
+        std::vector<char> buffer;
+        std::vector<std::string_view> names;
+
+      public:
+        /* Lists files whose name ends in extension, ignoring case. An empty extension matches all files. */
+        explicit DirectoryListing(char const *path, std::string_view extension = {});
+
+        DirectoryListing(DirectoryListing &&) = default;
+        DirectoryListing &operator=(DirectoryListing &&) = default;
+
+        /* Copies would point into the source buffer. */
+        DirectoryListing(DirectoryListing const &) = delete;
+        DirectoryListing &operator=(DirectoryListing const &) = delete;
+
+        auto begin() const { return names.begin(); }
+        auto end() const { return names.end(); }
+        std::size_t size() const { return names.size(); }
+        bool empty() const { return names.empty(); }
+    };
+
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ini_parser.hpp"
+
+#include <sys/stat.h>
+#include <cstdio>
+
+namespace Ini {
+
+    bool ReadFile(char const *path, std::vector<char> &buffer, std::size_t const offset) {
+        buffer.clear();
+
+        struct stat st;
+        if (stat(path, &st) != 0 || st.st_size < 0 || static_cast<std::size_t>(st.st_size) < offset)
+            return false;
+
+        auto const file = fopen(path, "rb");
+        if (file == nullptr)
+            return false;
+
+        if (offset != 0 && fseek(file, offset, SEEK_SET) != 0) {
+            fclose(file);
+            return false;
+        }
+
+        auto const size = static_cast<std::size_t>(st.st_size) - offset;
+
+        buffer.resize(size);
+        auto const ret = fread(buffer.data(), 1, buffer.size(), file);
+
+        fclose(file);
+
+        buffer.resize(ret);
+
+        return ret == size;
+    }
+
+}
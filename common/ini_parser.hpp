@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+namespace Ini {
+
+    constexpr inline std::string_view const Whitespace = " \t\r\n\f\v";
+
+    constexpr std::string_view Trim(std::string_view str) {
+        auto const begin = str.find_first_not_of(Whitespace);
+        if (begin == std::string_view::npos)
+            return {};
+
+        auto const end = str.find_last_not_of(Whitespace);
+        return str.substr(begin, end - begin + 1);
+    }
+
+    /* Reads the file from offset to its end into buffer with a single read. */
+    bool ReadFile(char const *path, std::vector<char> &buffer, std::size_t offset = 0);
+
+    /**
+     * Calls on_line(line, next) for every trimmed line which is neither empty nor a comment,
+     * next being the offset of the following line in data. Stops when on_line returns false.
+     */
+    template<typename LineFunction>
+    void ForEachLine(std::string_view const data, LineFunction on_line) {
+        std::size_t offset = 0;
+
+        /* Skip UTF-8 BOM. */
+        if (data.starts_with("\xEF\xBB\xBF"))
+            offset = 3;
+
+        while (offset < data.size()) {
+            auto const end  = data.find('\n', offset);
+            auto const next = (end == std::string_view::npos) ? data.size() : end + 1;
+            auto const line = Trim(data.substr(offset, next - offset));
+            offset = next;
+
+            if (line.empty() || line[0] == ';' || line[0] == '#')
+                continue;
+
+            if (!on_line(line, next))
+                break;
+        }
+    }
+
+    constexpr bool IsSection(std::string_view const line) {
+        return line.starts_with('[') && line.find(']') != std::string_view::npos;
+    }
+
+    constexpr std::string_view SectionName(std::string_view const line) {
+        return Trim(line.substr(1, line.find(']') - 1));
+    }
+
+    /**
+     * Tokenizes ini data in place, following hekate's ini rules: [section] headers,
+     * key=value pairs and ';' or '#' comment lines.
+     * on_section(name, offset) is called once per section header, offset being the start
+     * of the section body in data. on_key(section, key, value) is called for every pair.
+     * All views point into data.
+     */
+    template<typename SectionFunction, typename KeyFunction>
+    void Parse(std::string_view const data, SectionFunction on_section, KeyFunction on_key) {
+        std::string_view section;
+
+        ForEachLine(data, [&](std::string_view const line, std::size_t const next) {
+            if (line.starts_with('[')) {
+                if (IsSection(line)) {
+                    section = SectionName(line);
+                    on_section(section, next);
+                }
+
+                return true;
+            }
+
+            auto const separator = line.find('=');
+            if (separator != std::string_view::npos)
+                on_key(section, Trim(line.substr(0, separator)), Trim(line.substr(separator + 1)));
+
+            return true;
+        });
+    }
+
+    /* Calls on_key(key, value) for every pair of a section body, data starting at the body. */
+    template<typename KeyFunction>
+    void ParseSection(std::string_view const data, KeyFunction on_key) {
+        ForEachLine(data, [&](std::string_view const line, std::size_t) {
+            if (line.starts_with('['))
+                return false;
+
+            auto const separator = line.find('=');
+            if (separator != std::string_view::npos)
+                on_key(Trim(line.substr(0, separator)), Trim(line.substr(separator + 1)));
+
+            return true;
+        });
+    }
+
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "name_filter.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+namespace util {
+
+    namespace {
+
+        char Lower(char const c) {
+            return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+
+    }
+
+    void NameFilter::Reserve(std::size_t const count, std::size_t const bytes) {
+        names.reserve(count);
+        matches.reserve(count);
+        lowered.reserve(bytes);
+    }
+
+    std::uint32_t NameFilter::Add(std::string_view const name) {
+        auto const id = static_cast<std::uint32_t>(names.size());
+
+        auto const offset = lowered.size();
+        names.push_back({ static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(name.size()) });
+        std::transform(name.begin(), name.end(), std::back_inserter(lowered), Lower);
+
+        /* Keep the current query applied to late additions. */
+        if (query.empty() || std::string_view(lowered.data() + offset, name.size()).find(query) != std::string_view::npos)
+            matches.push_back(id);
+
+        return id;
+    }
+
+    void NameFilter::Set(std::string_view const next) {
+        std::string lower(next.size(), '\0');
+        std::transform(next.begin(), next.end(), lower.begin(), Lower);
+
+        /* Every match of the extended query also matched the previous one. */
+        bool const narrow = !query.empty() && std::string_view(lower).starts_with(query);
+
+        if (!narrow) {
+            matches.resize(names.size());
+            for (std::uint32_t i = 0; i < matches.size(); i++)
+                matches[i] = i;
+        }
+
+        query = std::move(lower);
+
+        if (query.empty())
+            return;
+
+        std::erase_if(matches, [this](std::uint32_t const id) {
+            auto const &name = names[id];
+            return std::string_view(lowered.data() + name.offset, name.size).find(query) == std::string_view::npos;
+        });
+    }
+
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+    /**
+     * Case insensitive substring filter over a fixed set of names. The names are
+     * lowered once into one buffer. A query that extends the previous one only
+     * rechecks the previous matches instead of every name.
+     */
+    class NameFilter {
+      private:
+        struct Name {
+            std::uint32_t offset;
+            std::uint32_t size;
+        };
+
+        std::vector<char> lowered;
+        std::vector<Name> names;
+        std::vector<std::uint32_t> matches;
+        std::string query;
+
+      public:
+        void Reserve(std::size_t const count, std::size_t const bytes);
+
+        /* Returns the id of the name, ids count up from 0. */
+        std::uint32_t Add(std::string_view const name);
+
+        /* Narrows or rebuilds the matches, an empty query matches every name. */
+        void Set(std::string_view const query);
+
+        std::string_view Query() const {
+            return query;
+        }
+
+        /* Ids of the matching names in ascending order. */
+        std::span<std::uint32_t const> Matches() const {
+            return matches;
+        }
+
+        std::size_t size() const {
+            return names.size();
+        }
+    };
+
+}
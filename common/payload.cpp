@@ -19,59 +19,88 @@
 #include "rtc_r2p.hpp"
 #include "reboot_to_payload.h"
 #include "ams_bpc.h"
-#include "ini.h"
+#include "trace.h"
+#include "config_index.hpp"
+#include "directory.hpp"
+#include "ini_parser.hpp"
 
-#include <unistd.h>
-#include <cstring>
-#include <dirent.h>
 #include <algorithm>
-#include <span>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 namespace Payload {
 
     namespace {
 
-        void RebootToPayload() {
-            /* Try reboot with safe ams bpc api. */
-            Result rc = amsBpcInitialize();
-            if (R_SUCCEEDED(rc)) {
-                rc = amsBpcSetRebootPayload(g_reboot_payload, IRAM_PAYLOAD_MAX_SIZE);
-                if (R_SUCCEEDED(rc)) {
-                    spsmShutdown(true);
-                }
-                amsBpcExit();
+        /* Length of the payload in g_reboot_payload, the rest of the buffer is 0xFF. */
+        std::size_t g_reboot_payload_size = 0;
+
+        enum class BpcSession {
+            Unknown,
+            Open,
+        };
+
+        /* Guarded by the hekate payload mutex, like every reboot. */
+        BpcSession g_bpc_session = BpcSession::Unknown;
+
+        /* Connects once, so rebooting only costs the SetRebootPayload call. */
+        void OpenBpcSession() {
+            if (g_bpc_session != BpcSession::Unknown)
+                return;
+
+            /* A failed connect stays Unknown, so the reboot tries again, e.g. once sm released its slot. */
+            if (R_SUCCEEDED(amsBpcInitialize())) {
+                g_bpc_session = BpcSession::Open;
+                util::RecordBpcAms();
             }
-            
-            /* Fallback to old smc reboot to payload. */
-            if (R_FAILED(rc))
-                smc_reboot_to_payload();
         }
 
-        int HekateConfigHandler(void *user, char const *section, char const *name, char const *value) {
-            auto const list = reinterpret_cast<HekateConfigList *>(user);
+        void RebootToPayload() {
+            OpenBpcSession();
 
-            /* Ignore pre-config and global config entries. */
-            if (section[0] == '\0' || std::strcmp(section, "config") == 0) {
-                return 1;
+            /* Try reboot with safe ams bpc api. */
+            if (g_bpc_session == BpcSession::Open && R_SUCCEEDED(amsBpcSetRebootPayload(g_reboot_payload, IRAM_PAYLOAD_MAX_SIZE))) {
+                traceDump();
+                spsmShutdown(true);
+                return;
             }
 
-            /* Find existing entry. */
-            auto it = std::find_if(list->begin(), list->end(), [section](HekateConfig &cfg) {
-                return cfg.name == section;
-            });
+            /* Fallback to old smc reboot to payload. */
+            smc_reboot_to_payload(g_reboot_payload_size);
+        }
+
+        void ParseHekateConfigs(char const *path, HekateConfigList &list, std::vector<char> &buffer) {
+            if (!Ini::ReadFile(path, buffer))
+                return;
 
-            /* Create config entry if not existant. */
-            HekateConfig &config = (it != list->end()) ? *it : list->emplace_back(section, list->size() + 1);
+            /* Every section starts with '[' and its name is shorter than its header line, so */
+            /* interning below never moves the buffer and source stays valid. */
+            list.Reserve(list.size() + std::count(buffer.begin(), buffer.end(), '['), list.StringSize() + buffer.size() + std::strlen(path) + 1);
 
-            /* TODO: parse more information and display that. */
-            (void)config;
+            auto const source = list.Intern(path);
 
-            (void)name;
-            (void)value;
+            /* Only record where each section starts, keys are decoded on demand. */
+            Ini::Parse({ buffer.data(), buffer.size() },
+                [&list, &source](std::string_view const section, std::size_t const offset) {
+                    /* Ignore pre-config and global config entries. */
+                    if (section.empty() || section == "config")
+                        return;
 
-            return 1;
+                    auto const name = list.Intern(section);
+                    list.Push({ .name = name, .index = list.size() + 1, .source = source, .offset = offset });
+                },
+                [](std::string_view, std::string_view, std::string_view) { });
         }
 
+        constexpr char const *const HekateIniPath = "sdmc:/bootloader/hekate_ipl.ini";
+        constexpr char const *const IniDir        = "sdmc:/bootloader/ini/";
+        constexpr char const *const IndexPath     = "sdmc:/bootloader/quickReBoot.idx";
+        constexpr char const *const RegistryPath  = "sdmc:/bootloader/quickReBoot.payloads";
+
         constexpr char const *const HekatePaths[] = {
             "sdmc:/atmosphere/reboot_payload.bin",
             "sdmc:/bootloader/update.bin",
@@ -85,9 +114,14 @@ namespace Payload {
             "sdmc:/payloads/",
         };
 
+        bool HekateMagicValid() {
+            return *(u32 *)(g_reboot_payload + Payload::MagicOffset) == Payload::Magic;
+        }
+
         bool LoadPayload(const char* path, bool hekate) {
             /* Clear payload buffer. */
             std::memset(g_reboot_payload, 0xFF, sizeof(g_reboot_payload));
+            g_reboot_payload_size = 0;
 
             /* Open payload. */
             auto const file = fopen(path, "r");
@@ -104,19 +138,91 @@ namespace Payload {
             if (ret == 0)
                 return false;
 
+            g_reboot_payload_size = ret;
+
             /* Check if payload has hekate magic. */
-            if (hekate && *(u32 *)(g_reboot_payload + Payload::MagicOffset) != Payload::Magic)
+            if (hekate && !HekateMagicValid())
+                return false;
+
+            return true;
+        }
+
+        /* Joins IniDir and name, false if the path does not fit. */
+        bool MakeIniPath(char (&path)[FS_MAX_PATH], std::string_view const name) {
+            auto const dir_length = std::strlen(IniDir);
+            if (dir_length + name.size() >= sizeof(path))
                 return false;
 
+            std::memcpy(path, IniDir, dir_length);
+            std::memcpy(path + dir_length, name.data(), name.size() + 1);
+
             return true;
         }
 
+        HekateConfigList ParseIniFiles(util::DirectoryListing const &listing) {
+            HekateConfigList configs;
+            std::vector<char> buffer;
+            char path[FS_MAX_PATH];
+
+            /* parse config */
+            for (auto const name : listing) {
+                if (MakeIniPath(path, name))
+                    ParseHekateConfigs(path, configs, buffer);
+            }
+
+            return configs;
+        }
+
+        /* The hekate payload currently held in g_reboot_payload, see PreloadHekatePayload. */
+        struct HekatePayloadCache {
+            std::mutex mutex;
+            Index::Source fingerprint;
+            bool loaded = false;
+        } g_hekate_payload;
+
+        std::optional<u32> ChecksumFile(char const *path, std::size_t const size, std::vector<u8> &buffer) {
+            buffer.resize(size);
+
+            auto const file = fopen(path, "rb");
+            if (file == nullptr)
+                return std::nullopt;
+
+            auto const ret = fread(buffer.data(), 1, buffer.size(), file);
+
+            fclose(file);
+
+            /* Truncated read. */
+            if (ret != size)
+                return std::nullopt;
+
+            return crc32Calculate(buffer.data(), size);
+        }
+
+        /* Must be called with the cache mutex held. */
         bool LoadHekatePayload() {
+            auto &cache = g_hekate_payload;
+
+            TraceScope const trace(TraceStage_LoadPayload);
+
+            /* Reuse the loaded payload while its file is unchanged. */
+            if (cache.loaded && Index::Stat(cache.fingerprint.path.c_str()) == cache.fingerprint.GetStamp() && HekateMagicValid())
+                return true;
+
+            cache.loaded = false;
+
             /* Iterate through the payload dirs */
             for (auto const path : HekatePaths) {
+                /* Skip missing files without opening them. */
+                auto const stamp = Index::Stat(path);
+                if (stamp.size <= 0)
+                    continue;
+
                 /* Try loading the payload */
-                if (LoadPayload(path, true))
+                if (LoadPayload(path, true)) {
+                    cache.fingerprint = { path, stamp.mtime, stamp.size };
+                    cache.loaded      = true;
                     return true;
+                }
             }
 
             return false;
@@ -124,58 +230,80 @@ namespace Payload {
 
     }
 
-    HekateConfigList LoadHekateConfigList() {
-        HekateConfigList configs;
-        ini_parse("sdmc:/bootloader/hekate_ipl.ini", HekateConfigHandler, &configs);
-        return configs;
+    std::string_view HekateMetadata::Get(std::string_view const key) const {
+        for (auto const &[name, value] : keys) {
+            if (name == key)
+                return value;
+        }
+
+        return {};
     }
 
-    HekateConfigList LoadIniConfigList() {
-        HekateConfigList configs;
+    std::string_view HekateMetadata::Tag() const {
+        if (Get("emummcforce") == "1")
+            return "emuMMC";
 
-        if (chdir("sdmc:/bootloader/ini") != 0)
-            return configs;
+        if (Get("emummc_force_disable") == "1")
+            return "sysMMC";
 
-        /* Open ini folder */
-        auto const dirp = opendir(".");
-        if (dirp == nullptr)
-            return configs;
+        if (!Get("payload").empty())
+            return "payload";
 
-        u32 count=0;
-        char dir_entries[8][0x100];
+        return {};
+    }
 
-        /* Get entries */
-        while (auto dent = readdir(dirp)) {
-            if (dent->d_type != DT_REG)
-                continue;
+    HekateMetadata const &HekateConfig::Metadata() const {
+        if (metadata)
+            return *metadata;
 
-            std::strcpy(dir_entries[count++], dent->d_name);
+        metadata = std::make_unique<HekateMetadata>();
 
-            if (count == std::size(dir_entries))
-                break;
+        /* The source is interned null terminated. */
+        std::vector<char> buffer;
+        if (Ini::ReadFile(source.data(), buffer, offset)) {
+            Ini::ParseSection({ buffer.data(), buffer.size() }, [this](std::string_view const key, std::string_view const value) {
+                metadata->keys.emplace_back(key, value);
+            });
         }
 
-        if (count > 1) {
-            /* Reorder ini files by ASCII ordering. */
-            char temp[0x100];
-            for (size_t i = 0; i < count - 1 ; i++) {
-                for (size_t j = i + 1; j < count; j++) {
-                    if (std::strcmp(dir_entries[i], dir_entries[j]) > 0) {
-                        std::strcpy(temp, dir_entries[i]);
-                        std::strcpy(dir_entries[i], dir_entries[j]);
-                        std::strcpy(dir_entries[j], temp);
-                    }
-                }
-            }
+        return *metadata;
+    }
+
+    HekateConfigList LoadHekateConfigList() {
+        HekateConfigList configs;
+        std::vector<char> buffer;
+        ParseHekateConfigs(HekateIniPath, configs, buffer);
+        return configs;
+    }
+
+    HekateConfigList LoadIniConfigList() {
+        return ParseIniFiles(util::DirectoryListing(IniDir, ".ini"));
+    }
+
+    BootConfigs LoadBootConfigs() {
+        util::DirectoryListing const ini_files(IniDir, ".ini");
+
+        /* Fingerprint every file the configs would be parsed from. */
+        Index::SourceList sources;
+        sources.reserve(1 + ini_files.size());
+        sources.push_back(Index::Fingerprint(HekateIniPath));
+
+        char path[FS_MAX_PATH];
+        for (auto const name : ini_files) {
+            if (MakeIniPath(path, name))
+                sources.push_back(Index::Fingerprint(path));
         }
 
-        /* parse config */
-        for (auto const &entry : std::span(dir_entries, count))
-            ini_parse(entry, HekateConfigHandler, &configs);
+        /* Nothing changed since the last scan. */
+        if (auto cached = Index::Load(IndexPath, sources))
+            return std::move(*cached);
 
-        closedir(dirp);
+        BootConfigs configs = {
+            .boot = LoadHekateConfigList(),
+            .ini  = ParseIniFiles(ini_files),
+        };
 
-        chdir("sdmc:/");
+        Index::Store(IndexPath, sources, configs);
 
         return configs;
     }
@@ -183,50 +311,117 @@ namespace Payload {
     PayloadConfigList LoadPayloadList() {
         PayloadConfigList res;
 
+        /* Unchanged records are kept as they are, only new or changed payloads copy their path. */
+        auto registry = Index::LoadPayloadRegistry(RegistryPath);
+        std::vector<bool> kept(registry.size());
+        Index::PayloadRegistry added;
+
+        std::vector<u8> buffer;
+        char path[FS_MAX_PATH];
+
         /* Iterate through all the payload folders */
-        for (const auto& path : PayloadDirs) {
+        for (auto const dir : PayloadDirs) {
+            util::DirectoryListing const listing(dir, ".bin");
 
-            if (chdir(path) != 0)
-                continue;
+            auto const dir_length = std::strlen(dir);
 
-            /* Open `path` folder */
-            auto const dirp = opendir(".");
-            if (dirp == nullptr)
-                continue;
+            std::size_t string_size = 0;
+            for (auto const name : listing)
+                string_size += dir_length + name.size() + 1;
 
-            /* Get entries */
-            while (auto const dent = readdir(dirp)) {
-                if (dent->d_type != DT_REG)
+            res.Reserve(res.size() + listing.size(), res.StringSize() + string_size);
+
+            /* Every path of the folder shares the prefix. */
+            std::memcpy(path, dir, dir_length);
+
+            for (auto const name : listing) {
+                /* Name is stored as part of the path. */
+                if (dir_length + name.size() >= sizeof(path))
                     continue;
 
-                /* Get payloads */
-                std::string const name(dent->d_name);
-                if (name.substr(name.size() - 4) == ".bin")
-                    res.emplace_back(name.substr(0, name.size() - 4), (path + name));
-            }
+                std::memcpy(path + dir_length, name.data(), name.size() + 1);
+
+                auto const stamp = Index::Stat(path);
+                bool valid = stamp.size > 0 && stamp.size <= IRAM_PAYLOAD_MAX_SIZE;
+
+                /* Only checksum payloads which are new or changed. */
+                u32 crc = 0;
+                if (valid) {
+                    auto const record = std::lower_bound(registry.begin(), registry.end(), std::string_view(path), [](auto const &record, std::string_view const path) {
+                        return record.source.path < path;
+                    });
+
+                    if (record != registry.end() && record->source.path == path && record->source.GetStamp() == stamp) {
+                        crc = record->crc;
+                        kept[record - registry.begin()] = true;
+                    } else if (auto const checksum = ChecksumFile(path, stamp.size, buffer)) {
+                        crc = *checksum;
+                        added.push_back({ { path, stamp.mtime, stamp.size }, crc });
+                    } else {
+                        valid = false;
+                    }
+                }
 
-            closedir(dirp);
+                auto const interned = res.Intern(path);
+                res.Push({ .name = interned.substr(dir_length, name.size() - 4), .path = interned, .size = static_cast<std::size_t>(stamp.size), .crc = crc, .valid = valid });
+            }
         }
 
-        chdir("sdmc:/");
+        /* Rewrite the registry only if payloads were added, changed or removed. */
+        if (!added.empty() || std::find(kept.begin(), kept.end(), false) != kept.end()) {
+            for (std::size_t i = 0; i < registry.size(); i++) {
+                if (kept[i])
+                    added.push_back(std::move(registry[i]));
+            }
+
+            std::sort(added.begin(), added.end(), [](auto const &lhs, auto const &rhs) {
+                return lhs.source.path < rhs.source.path;
+            });
+
+            Index::StorePayloadRegistry(RegistryPath, added);
+        }
 
         return res;
     }
 
-    template<typename ConfigureFunction>
-    bool Reboot(ConfigureFunction func) {
-        /* Load payload. */
-        if (!LoadHekatePayload())
+    void PreloadHekatePayload() {
+        /* Only erista reboots through the payload. */
+        if (!util::IsErista())
+            return;
+
+        std::scoped_lock lock(g_hekate_payload.mutex);
+        OpenBpcSession();
+        LoadHekatePayload();
+    }
+
+    void ClosePreloadSession() {
+        std::scoped_lock lock(g_hekate_payload.mutex);
+
+        if (g_bpc_session == BpcSession::Open)
+            amsBpcExit();
+
+        g_bpc_session = BpcSession::Unknown;
+    }
+
+    bool Reboot(BootRequest const &request) {
+        if (!util::IsErista()) {
+            Max77620Rtc::rtc_reboot_reason_t const rr = request.ToRtc();
+            return Max77620Rtc::Reboot(&rr);
+        }
+
+        if (!request.SupportsErista())
             return false;
 
-        /* Get boot storage pointer. */
-        auto const storage = reinterpret_cast<BootStorage *>(g_reboot_payload + BootStorageOffset);
+        TraceScope const trace(TraceStage_Reboot);
+        std::scoped_lock lock(g_hekate_payload.mutex);
 
-        /* Clear boot storage. */
-        std::memset(storage, 0, sizeof(BootStorage));
+        /* Load payload. */
+        if (!LoadHekatePayload())
+            return false;
 
-        /* Configure boot storage */
-        func(storage);
+        /* Write boot storage. */
+        BootStorage const storage = request.ToBootStorage();
+        std::memcpy(g_reboot_payload + BootStorageOffset, &storage, sizeof(BootStorage));
 
         /* Reboot */
         RebootToPayload();
@@ -235,73 +430,41 @@ namespace Payload {
     }
 
     bool RebootToHekate() {
-        if (util::IsErista()) {
-            return Reboot([&] (BootStorage *storage) {
-                /* No-Op */
-            });
-        } else {
-            Max77620Rtc::rtc_reboot_reason_t rr {.dec = {
-                .reason = Max77620Rtc::REBOOT_REASON_NOP,
-            }};
-            return Max77620Rtc::Reboot(&rr);
-        }
+        return Reboot(BootRequest::Hekate());
     }
 
     bool RebootToHekateConfig(HekateConfig const &config, bool const autoboot_list) {
-        if (util::IsErista()) {
-            return Reboot([&] (BootStorage *storage) {
-                /* Force autoboot and set boot id. */
-                storage->boot_cfg      = BootCfg_ForceAutoBoot;
-                storage->autoboot      = config.index;
-                storage->autoboot_list = autoboot_list;
-            });
-        } else {
-            Max77620Rtc::rtc_reboot_reason_t rr {.dec = {
-                .reason = Max77620Rtc::REBOOT_REASON_SELF,
-                .autoboot_idx = static_cast<u16>(config.index & 0xf),
-                .autoboot_list = autoboot_list,
-            }};
-            return Max77620Rtc::Reboot(&rr);
-        }
+        return Reboot(BootRequest::Config(config.index, autoboot_list));
     }
 
     bool RebootToHekateUMS(UmsTarget const target) {
-        if (util::IsErista()) {
-            return Reboot([&] (BootStorage *storage) {
-                /* Force boot to menu, target UMS and select target. */
-                storage->boot_cfg  = BootCfg_ForceAutoBoot;
-                storage->extra_cfg = ExtraCfg_NyxUms;
-                storage->autoboot  = 0;
-                storage->ums       = target;
-            });
-        } else {
-            Max77620Rtc::rtc_reboot_reason_t rr {.dec = {
-                .reason = Max77620Rtc::REBOOT_REASON_UMS,
-                .ums_idx = target,
-            }};
-            return Max77620Rtc::Reboot(&rr);
-        }
+        return Reboot(BootRequest::Ums(target));
     }
 
     bool RebootToHekateMenu() { // CUSTOM MODIFICATION
-        if (util::IsErista()) {
-            return Reboot([&] (BootStorage *storage) {
-                /* Force boot to menu */
-                storage->boot_cfg  = BootCfg_ForceAutoBoot;
-                storage->autoboot  = 0;
-            });
-        } else {
-            Max77620Rtc::rtc_reboot_reason_t rr {.dec = {
-                .reason = Max77620Rtc::REBOOT_REASON_MENU,
-            }};
-            return Max77620Rtc::Reboot(&rr);
-        }
+        return Reboot(BootRequest::Menu());
     }
 
     bool RebootToPayload(PayloadConfig const &config) {
+        if (!config.valid)
+            return false;
+
         if (util::IsErista()) {
+            TraceScope const trace(TraceStage_Reboot);
+            std::scoped_lock lock(g_hekate_payload.mutex);
+
+            /* Replaces the preloaded hekate payload. */
+            g_hekate_payload.loaded = false;
+
             /* Load payload. */
-            if (!LoadPayload(config.path.c_str(), false))
+            {
+                TraceScope const load_trace(TraceStage_LoadPayload);
+                if (!LoadPayload(config.path.data(), false))
+                    return false;
+            }
+
+            /* Refuse payloads which changed or got corrupted since they were checked. */
+            if (g_reboot_payload_size != config.size || crc32Calculate(g_reboot_payload, g_reboot_payload_size) != config.crc)
                 return false;
 
             /* Reboot */
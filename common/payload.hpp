@@ -15,80 +15,80 @@
  */
 #pragma once
 
-#include <list>
+#include "boot_request.hpp"
+#include "config_list.hpp"
+
+#include <array>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include <switch.h>
 #include <cstdint>
 
 namespace Payload {
 
-    enum BootCfg {
-        BootCfg_ForceAutoBoot = 1 << 0,
-        BootCfg_ShowLaunchLog = 1 << 1,
-        BootCfg_BootFromId    = 1 << 2,
-        BootCfg_BootToEmuMMC  = 1 << 3,
-        BootCfg_SeptRun       = 1 << 7,
-    };
+    constexpr inline std::size_t const BootStorageOffset = 0x94;
+    constexpr inline std::size_t const MagicOffset       = BootStorageOffset + sizeof(BootStorage);
+    constexpr inline std::uint32_t const Magic           = 0x43544349; /* ICTC */
 
-    enum ExtraCfg {
-        ExtraCfg_Keys      = 1 << 0,
-        ExtraCfg_Payload   = 1 << 1,
-        ExtraCfg_Module    = 1 << 2,
-        ExtraCfg_NyxBis    = 1 << 4,
-        ExtraCfg_NyxUms    = 1 << 5,
-        ExtraCfg_NyxReload = 1 << 6,
-        ExtraCfg_NyxDump   = 1 << 7,
-    };
+    /* All key/value pairs of a hekate config section, e.g. payload, icon, id or emummcforce. */
+    struct HekateMetadata {
+        std::vector<std::pair<std::string, std::string>> keys;
 
-    enum UmsTarget {
-        UmsTarget_Sd,
-        UmsTarget_NandBoot0,
-        UmsTarget_NandBoot1,
-        UmsTarget_Nand,
-        UmsTarget_EmuMMCBoot0,
-        UmsTarget_EmuMMCBoot1,
-        UmsTarget_EmuMMC,
-    };
+        std::string_view Get(std::string_view const key) const;
 
-    // clang-format off
-    struct BootStorage {
-        /* 0x94 */  u8 boot_cfg;
-        /* 0x95 */  u8 autoboot;
-        /* 0x96 */  u8 autoboot_list;
-        /* 0x97 */  u8 extra_cfg;
-        /* 0x98 */  union {
-        /*      */      struct {
-        /* 0x98 */          char id[8];
-        /* 0xA0 */          char emummc_path[0x78];
-        /*      */      };
-        /* 0x98 */      u8 ums;
-        /* 0x98 */      u8 xt_str[0x80];
-        /*      */  };
+        /* Short tag for menus: emuMMC, sysMMC, payload or empty. */
+        std::string_view Tag() const;
     };
-    // clang-format on
 
-    static_assert(sizeof(BootStorage) == 0x84, "Boot storage size!");
+    struct HekateConfig {
+        std::string_view name;
+        std::size_t index;
 
-    constexpr inline std::size_t const BootStorageOffset = 0x94;
-    constexpr inline std::size_t const MagicOffset       = BootStorageOffset + sizeof(BootStorage);
-    constexpr inline std::uint32_t const Magic           = 0x43544349; /* ICTC */
+        /* Ini file and offset of the section body, the keys are decoded on first access. */
+        std::string_view source;
+        std::size_t offset;
+        mutable std::unique_ptr<HekateMetadata> metadata;
 
-    struct HekateConfig {
-        std::string const name;
-        std::size_t const index;
+        HekateMetadata const &Metadata() const;
+
+        static constexpr std::array Strings = { &HekateConfig::name, &HekateConfig::source };
     };
 
     struct PayloadConfig {
-        std::string const name;
-        std::string const path;
+        std::string_view name;
+        std::string_view path;
+
+        /* Checked once when the payload is discovered, verified again before rebooting. */
+        std::size_t size;
+        u32 crc;
+        bool valid;
+
+        static constexpr std::array Strings = { &PayloadConfig::name, &PayloadConfig::path };
     };
 
-    using HekateConfigList = std::list<HekateConfig>;
-    using PayloadConfigList = std::list<PayloadConfig>;
+    using HekateConfigList = ConfigList<HekateConfig>;
+    using PayloadConfigList = ConfigList<PayloadConfig>;
+
+    struct BootConfigs {
+        HekateConfigList boot;
+        HekateConfigList ini;
+    };
 
     HekateConfigList LoadHekateConfigList();
     HekateConfigList LoadIniConfigList();
+    BootConfigs LoadBootConfigs();
+
+    /* Resolves and loads the hekate payload and connects to bpc:ams ahead of time, */
+    /* so rebooting only has to verify the payload and hand it over. */
+    void PreloadHekatePayload();
+    void ClosePreloadSession();
     PayloadConfigList LoadPayloadList();
+
+    /* Reboots into hekate, through the boot storage on erista and the RTC on mariko. */
+    bool Reboot(BootRequest const &request);
     bool RebootToHekate();
     bool RebootToHekateConfig(HekateConfig const &config, bool const autoboot_list);
     bool RebootToHekateUMS(UmsTarget const target);
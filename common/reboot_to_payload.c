@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "reboot_to_payload.h"
+#include "trace.h"
 
 #include <string.h>
 #include <switch.h>
@@ -23,39 +24,32 @@
 
 alignas(0x1000) u8 g_reboot_payload[IRAM_PAYLOAD_MAX_SIZE];
 static alignas(0x1000) u8 g_ff_page[0x1000];
-static alignas(0x1000) u8 g_work_page[0x1000];
-
-static void do_iram_dram_copy(void *buf, uintptr_t iram_addr, size_t size, int option) {
-    memcpy(g_work_page, buf, size);
 
+/* buf has to be a single page, the secure monitor call translates it as such. */
+static void copy_to_iram(uintptr_t iram_addr, const void *buf, size_t size) {
     SecmonArgs args = {0};
-    args.X[0]       = 0xF0000201;             /* smcAmsIramCopy */
-    args.X[1]       = (uintptr_t)g_work_page; /* DRAM Address */
-    args.X[2]       = iram_addr;              /* IRAM Address */
-    args.X[3]       = size;                   /* Copy size */
-    args.X[4]       = option;                 /* 0 = Read, 1 = Write */
+    args.X[0]       = 0xF0000201;     /* smcAmsIramCopy */
+    args.X[1]       = (uintptr_t)buf; /* DRAM Address */
+    args.X[2]       = iram_addr;      /* IRAM Address */
+    args.X[3]       = size;           /* Copy size */
+    args.X[4]       = 1;              /* 0 = Read, 1 = Write */
     svcCallSecureMonitor(&args);
-
-    memcpy(buf, g_work_page, size);
 }
 
-static void copy_to_iram(uintptr_t iram_addr, void *buf, size_t size) {
-    do_iram_dram_copy(buf, iram_addr, size, 1);
-}
+void smc_reboot_to_payload(size_t payload_size) {
+    u32 span = traceBegin(TraceStage_IramCopy);
 
-static void clear_iram(void) {
     memset(g_ff_page, 0xFF, sizeof(g_ff_page));
+
+    /* Write every page once: pages covered by the payload straight from the page aligned */
+    /* payload buffer (padded with 0xFF), the remaining ones cleared. */
     for (size_t i = 0; i < IRAM_PAYLOAD_MAX_SIZE; i += sizeof(g_ff_page)) {
-        copy_to_iram(IRAM_PAYLOAD_BASE + i, g_ff_page, sizeof(g_ff_page));
+        const void *src = (i < payload_size) ? &g_reboot_payload[i] : g_ff_page;
+        copy_to_iram(IRAM_PAYLOAD_BASE + i, src, sizeof(g_ff_page));
     }
-}
-
-void smc_reboot_to_payload(void) {
-    clear_iram();
 
-    for (size_t i = 0; i < IRAM_PAYLOAD_MAX_SIZE; i += 0x1000) {
-        copy_to_iram(IRAM_PAYLOAD_BASE + i, &g_reboot_payload[i], 0x1000);
-    }
+    traceEnd(span);
+    traceDump();
 
     splSetConfig((SplConfigItem)65001, 2);
 }
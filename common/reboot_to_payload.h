@@ -25,7 +25,8 @@ extern "C" {
 
 extern u8 g_reboot_payload[IRAM_PAYLOAD_MAX_SIZE];
 
-void smc_reboot_to_payload(void);
+/* Bytes of g_reboot_payload past payload_size must be 0xFF. */
+void smc_reboot_to_payload(size_t payload_size);
 
 #ifdef __cplusplus
 }
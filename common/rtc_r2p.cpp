@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "rtc_r2p.hpp"
+#include "trace.h"
 
 //#include <cstdio>
 
@@ -37,6 +38,8 @@ namespace Max77620Rtc {
 	#define  MAX77620_RTC_READ_UPDATE   BIT(4)
 
 	#define MAX77620_RTC_UPDATE1_REG    0x05
+	#define  MAX77620_RTC_WRITE_DONE    BIT(0)
+	#define  MAX77620_RTC_READ_DONE     BIT(4)
 	#define MAX77620_RTC_RTCSMPL_REG    0x06
 
 	#define MAX77620_RTC_SEC_REG        0x07
@@ -64,6 +67,12 @@ namespace Max77620Rtc {
 	#define MAX77620_ALARM2_DATE_REG    0x1B
 	#define  MAX77620_RTC_ALARM_EN_MASK	BIT(7)
 
+	#define MAX77620_ALARM_REGS_COUNT   (MAX77620_RTC_NR_TIME_REGS * 2)
+
+	// Upper bound for an RTC buffer update, formerly slept unconditionally.
+	#define MAX77620_RTC_UPDATE_TIMEOUT_NS 16'000'000ul
+	#define MAX77620_RTC_UPDATE_POLL_NS     1'000'000ul
+
 	namespace {
 
 		bool i2c_send_byte(I2cSession &session, u8 reg, u8 val) {
@@ -108,33 +117,94 @@ namespace Max77620Rtc {
 			return true;
 		}
 
-		bool max77620_rtc_stop_alarm(I2cSession &session) {
+		bool i2c_recv_regs(I2cSession &session, u8 reg, u8 *out, size_t size) {
+			Result rc = 0;
+
+			// Register address auto increments, so one receive reads the whole block.
+			if (R_FAILED(rc = i2csessionSendAuto(&session, &reg, sizeof(reg), I2cTransactionOption_All))) {
+				return false;
+			}
+
+			if (R_FAILED(rc = i2csessionReceiveAuto(&session, out, size, I2cTransactionOption_All))) {
+				return false;
+			}
+
+			return true;
+		}
+
+		bool i2c_send_regs(I2cSession &session, u8 reg, u8 const *vals, size_t size) {
+			u8 cmd[1 + MAX77620_ALARM_REGS_COUNT];
+
+			if (size > sizeof(cmd) - 1) {
+				return false;
+			}
+
+			cmd[0] = reg;
+			for (size_t i = 0; i < size; i++) {
+				cmd[1 + i] = vals[i];
+			}
+
+			return R_SUCCEEDED(i2csessionSendAuto(&session, cmd, 1 + size, I2cTransactionOption_All));
+		}
+
+		bool max77620_rtc_update(I2cSession &session, u8 update, u8 done) {
+			u32 const span = traceBegin(TraceStage_RtcUpdate);
 			u8 val = 0;
 
+			// Reading UPDATE1 clears stale done flags.
+			if (!i2c_recv_byte(session, MAX77620_RTC_UPDATE1_REG, &val) ||
+				!i2c_send_byte(session, MAX77620_RTC_UPDATE0_REG, update)) {
+				traceEnd(span);
+				return false;
+			}
+
+			// Poll for the done flag instead of always sleeping the worst case.
+			for (u64 waited = 0; waited < MAX77620_RTC_UPDATE_TIMEOUT_NS; waited += MAX77620_RTC_UPDATE_POLL_NS) {
+				svcSleepThread(MAX77620_RTC_UPDATE_POLL_NS);
+
+				if (i2c_recv_byte(session, MAX77620_RTC_UPDATE1_REG, &val) && (val & done)) {
+					break;
+				}
+			}
+
+			traceEnd(span);
+
+			return true;
+		}
+
+		bool max77620_rtc_set_reboot_reason(I2cSession &session, rtc_reboot_reason_t const* rr) {
+			u8 alarm[MAX77620_ALARM_REGS_COUNT];
+
 			// Update RTC regs from RTC clock.
-			if (!i2c_send_byte(session, MAX77620_RTC_UPDATE0_REG, MAX77620_RTC_READ_UPDATE)) {
+			if (!max77620_rtc_update(session, MAX77620_RTC_READ_UPDATE, MAX77620_RTC_READ_DONE)) {
+				return false;
+			}
+
+			// Read both alarm blocks at once.
+			if (!i2c_recv_regs(session, MAX77620_ALARM1_SEC_REG, alarm, sizeof(alarm))) {
 				return false;
 			}
-			svcSleepThread(16'000'000ul);
 
 			// Stop alarm for both ALARM1 and ALARM2. Horizon uses ALARM2.
-			for (int i = 0; i < (MAX77620_RTC_NR_TIME_REGS * 2); i++)
-			{
-				if (!i2c_recv_byte(session, MAX77620_ALARM1_SEC_REG + i, &val)) {
-					return false;
-				}
+			for (auto &val : alarm) {
 				val &= ~MAX77620_RTC_ALARM_EN_MASK;
-				if (!i2c_send_byte(session, MAX77620_ALARM1_SEC_REG + i, val)) {
-					return false;
-				}
 			}
 
-			// Update RTC clock from RTC regs.
-			auto const ret = i2c_send_byte(session, MAX77620_RTC_UPDATE0_REG, MAX77620_RTC_WRITE_UPDATE);
+			// Set reboot reason.
+			alarm[MAX77620_ALARM1_YEAR_REG - MAX77620_ALARM1_SEC_REG] = rr->enc.val1;
+			alarm[MAX77620_ALARM2_YEAR_REG - MAX77620_ALARM1_SEC_REG] = rr->enc.val2;
 
-			svcSleepThread(16'000'000ul);
+			// Set reboot reason magic.
+			alarm[MAX77620_ALARM1_WEEKDAY_REG - MAX77620_ALARM1_SEC_REG] = RTC_REBOOT_REASON_MAGIC;
+			alarm[MAX77620_ALARM2_WEEKDAY_REG - MAX77620_ALARM1_SEC_REG] = RTC_REBOOT_REASON_MAGIC;
 
-			return ret;
+			// Write both alarm blocks back at once.
+			if (!i2c_send_regs(session, MAX77620_ALARM1_SEC_REG, alarm, sizeof(alarm))) {
+				return false;
+			}
+
+			// Update RTC clock from RTC regs.
+			return max77620_rtc_update(session, MAX77620_RTC_WRITE_UPDATE, MAX77620_RTC_WRITE_DONE);
 		}
 
 	}
@@ -149,24 +219,20 @@ namespace Max77620Rtc {
 			return false;
 		}
 
-		bool ret = 
-			max77620_rtc_stop_alarm(session) &&
+		u32 const span = traceBegin(TraceStage_RtcReboot);
 
-			// Set reboot reason.
-			i2c_send_byte(session, MAX77620_ALARM1_YEAR_REG, rr->enc.val1) &&
-			i2c_send_byte(session, MAX77620_ALARM2_YEAR_REG, rr->enc.val2) &&
+		bool const ret = max77620_rtc_set_reboot_reason(session, rr);
 
-			// Set reboot reason magic.
-			i2c_send_byte(session, MAX77620_ALARM1_WEEKDAY_REG, RTC_REBOOT_REASON_MAGIC) &&
-			i2c_send_byte(session, MAX77620_ALARM2_WEEKDAY_REG, RTC_REBOOT_REASON_MAGIC) &&
+		i2csessionClose(&session);
 
-			// Update RTC clock from RTC regs.
-			i2c_send_byte(session, MAX77620_RTC_UPDATE0_REG, MAX77620_RTC_WRITE_UPDATE);
+		traceEnd(span);
 
-		svcSleepThread(16'000'000ul);
+		if (!ret) {
+			return false;
+		}
 
-		i2csessionClose(&session);
+		traceDump();
 
-		return ret && R_SUCCEEDED(spsmShutdown(true));
+		return R_SUCCEEDED(spsmShutdown(true));
 	}
 }
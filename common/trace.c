@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "trace.h"
+
+#ifdef QRB_PROFILE
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define TRACE_MAX_SPANS 64 /* Power of two. */
+
+typedef struct {
+    u32 seq;
+    u32 stage;
+    u64 begin;
+    u64 end;
+} TraceSpan;
+
+static TraceSpan g_trace_spans[TRACE_MAX_SPANS];
+static atomic_uint g_trace_seq;
+
+static const char *const g_trace_stage_names[TraceStage_Count] = {
+    [TraceStage_Reboot]                 = "reboot",
+    [TraceStage_LoadPayload]            = "load_payload",
+    [TraceStage_AmsBpcInitialize]       = "ams_bpc_initialize",
+    [TraceStage_AmsBpcSetRebootPayload] = "ams_bpc_set_reboot_payload",
+    [TraceStage_IramCopy]               = "iram_copy",
+    [TraceStage_RtcUpdate]              = "rtc_update",
+    [TraceStage_RtcReboot]              = "rtc_reboot",
+};
+
+u32 traceBegin(TraceStage stage) {
+    /* Sequence numbers start at 1, so 0 marks an unused slot. */
+    u32 const seq = atomic_fetch_add(&g_trace_seq, 1) + 1;
+    TraceSpan *const span = &g_trace_spans[seq & (TRACE_MAX_SPANS - 1)];
+
+    span->seq   = seq;
+    span->stage = stage;
+    span->begin = armGetSystemTick();
+    span->end   = 0;
+
+    return seq;
+}
+
+void traceEnd(u32 seq) {
+    TraceSpan *const span = &g_trace_spans[seq & (TRACE_MAX_SPANS - 1)];
+
+    /* Slot was reused in the meantime. */
+    if (span->seq == seq)
+        span->end = armGetSystemTick();
+}
+
+void traceDump(void) {
+    u32 const last = atomic_load(&g_trace_seq);
+    u32 const first = (last > TRACE_MAX_SPANS) ? last - TRACE_MAX_SPANS + 1 : 1;
+    u64 const now = armGetSystemTick();
+
+    FILE *const file = fopen(TRACE_PATH, "w");
+    if (file == NULL)
+        return;
+
+    fprintf(file, "%-28s %12s %12s\n", "stage", "start_us", "duration_us");
+
+    struct {
+        u32 count;
+        u64 total_us;
+        u64 max_us;
+    } totals[TraceStage_Count] = {};
+
+    u64 origin = 0;
+    for (u32 seq = first; seq != 0 && seq <= last; seq++) {
+        const TraceSpan *const span = &g_trace_spans[seq & (TRACE_MAX_SPANS - 1)];
+        if (span->seq != seq)
+            continue;
+
+        if (origin == 0)
+            origin = span->begin;
+
+        /* Spans still open at dump time end now. */
+        u64 const end = span->end ? span->end : now;
+        u64 const duration_us = armTicksToNs(end - span->begin) / 1000;
+
+        fprintf(file, "%-28s %12llu %12llu%s\n",
+                g_trace_stage_names[span->stage],
+                (unsigned long long)(armTicksToNs(span->begin - origin) / 1000),
+                (unsigned long long)duration_us,
+                span->end ? "" : " (open)");
+
+        totals[span->stage].count++;
+        totals[span->stage].total_us += duration_us;
+        if (duration_us > totals[span->stage].max_us)
+            totals[span->stage].max_us = duration_us;
+    }
+
+    /* Per stage report, stages that ran several times (retries, rescans) add up here. */
+    fprintf(file, "\n%-28s %8s %12s %12s\n", "stage", "count", "total_us", "max_us");
+
+    for (u32 stage = 0; stage < TraceStage_Count; stage++) {
+        if (totals[stage].count == 0)
+            continue;
+
+        fprintf(file, "%-28s %8u %12llu %12llu\n",
+                g_trace_stage_names[stage],
+                (unsigned)totals[stage].count,
+                (unsigned long long)totals[stage].total_us,
+                (unsigned long long)totals[stage].max_us);
+    }
+
+    fclose(file);
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <switch.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stages of the reboot path. */
+typedef enum {
+    TraceStage_Reboot,
+    TraceStage_LoadPayload,
+    TraceStage_AmsBpcInitialize,
+    TraceStage_AmsBpcSetRebootPayload,
+    TraceStage_IramCopy,
+    TraceStage_RtcUpdate,
+    TraceStage_RtcReboot,
+    TraceStage_Count,
+} TraceStage;
+
+#define TRACE_PATH "sdmc:/bootloader/quickReBoot.trace"
+
+/*
+ * Tick stamped spans in a fixed ring buffer, only compiled in with PROFILE=1.
+ * traceDump writes the recorded spans to TRACE_PATH, followed by count, total
+ * and max duration per stage. It is called right before the console reboots.
+ */
+#ifdef QRB_PROFILE
+
+u32  traceBegin(TraceStage stage);
+void traceEnd(u32 span);
+void traceDump(void);
+
+#else
+
+static inline u32 traceBegin(TraceStage stage) { (void)stage; return 0; }
+static inline void traceEnd(u32 span) { (void)span; }
+static inline void traceDump(void) { }
+
+#endif
+
+#ifdef __cplusplus
+}
+
+/* Ends the span when leaving the scope. */
+class TraceScope {
+  private:
+    u32 const span;
+
+  public:
+    explicit TraceScope(TraceStage const stage) : span(traceBegin(stage)) { }
+    ~TraceScope() { traceEnd(span); }
+
+    TraceScope(TraceScope const &) = delete;
+    TraceScope &operator=(TraceScope const &) = delete;
+};
+#endif
@@ -17,8 +17,7 @@
 
 #include <switch.h>
 
-#include <optional>
-//#include <cstdio>
+#include <cstdio>
 
 /// Console Product Models
 //typedef enum {
@@ -37,55 +36,84 @@
  */
 //Result setsysGetProductModel(SetSysProductModel *model);
 
+namespace {
+
+    util::Capabilities g_capabilities = {};
+
+    util::Soc GetSoc(SetSysProductModel const model) {
+        switch (model) {
+            case SetSysProductModel_Nx:
+            case SetSysProductModel_Copper:
+                return util::Soc::Erista;
+            case SetSysProductModel_Iowa:
+            case SetSysProductModel_Hoag:
+            case SetSysProductModel_Calcio:
+            case SetSysProductModel_Aula:
+                return util::Soc::Mariko;
+            default:
+                return util::Soc::Unknown;
+        }
+    }
+
+}
+
 namespace util {
-    
+
+    void ProbeCapabilities() {
+        auto &caps = g_capabilities;
+
+        caps.model = SetSysProductModel_Invalid;
+        setsysGetProductModel(&caps.model);
+        caps.soc = GetSoc(caps.model);
+
+        /* Exosphère reports its version through a custom config item. */
+        u64 version = 0;
+        caps.ams_major = caps.ams_minor = caps.ams_micro = 0;
+        if (R_SUCCEEDED(splGetConfig(static_cast<SplConfigItem>(65000), &version))) {
+            caps.ams_major = (version >> 56) & 0xff;
+            caps.ams_minor = (version >> 48) & 0xff;
+            caps.ams_micro = (version >> 40) & 0xff;
+        }
+
+        /* bpc:ams is left to the first session the payload code opens, see RecordBpcAms. */
+        caps.bpc_ams = false;
+    }
+
+    Capabilities const &GetCapabilities() {
+        return g_capabilities;
+    }
+
+    void RecordBpcAms() {
+        g_capabilities.bpc_ams = true;
+    }
+
     bool IsErista() { // CUSTOM MODIFICATION
-        SetSysProductModel model = SetSysProductModel_Invalid;
-        setsysGetProductModel(&model);
-        
-        if (model == SetSysProductModel_Nx || \
-            model == SetSysProductModel_Copper)
-            return true;
-        
-        return false;
+        return g_capabilities.soc == Soc::Erista;
     }
-    
-    
+
     bool IsMariko() { // CUSTOM MODIFICATION
-        SetSysProductModel model = SetSysProductModel_Invalid;
-        setsysGetProductModel(&model);
-        
-        if (model == SetSysProductModel_Iowa || \
-            model == SetSysProductModel_Hoag || \
-            model == SetSysProductModel_Calcio || \
-            model == SetSysProductModel_Aula)
-            return true;
-        
-        return false;
+        return g_capabilities.soc == Soc::Mariko;
     }
 
-
     /**
      * Since 1.6.0, Atmosphère bpc-mitm overwrites the reboot on mariko to prevent clearing
      * Timers. We are using those timing registers to communicate with hekate.
      */
     bool SupportsMarikoRebootToConfig() {
-        static std::optional<bool> impl;
-
-        if (impl.has_value())
-            return *impl;
-
-        u64 version = 0;
-        
-        if (R_FAILED(splGetConfig(static_cast<SplConfigItem>(65000), &version)))
-            return false;
+        return g_capabilities.ams_major >= 1 && g_capabilities.ams_minor >= 6;
+    }
 
-        const u32 version_minor = (version >> 48) & 0xff;
-        const u32 version_major = (version >> 56) & 0xff;
+    std::string StageProfile::Format() const {
+        std::string res;
+        char buffer[0x40];
 
-        impl = (version_major >= 1 && version_minor >= 6);
+        for (std::size_t i = 0; i < count; i++) {
+            auto const &stage = stages[i];
+            std::snprintf(buffer, sizeof(buffer), "%s%s %lluus/%zu", i ? " | " : "", stage.name, static_cast<unsigned long long>(stage.us), stage.entries);
+            res += buffer;
+        }
 
-        return *impl;
+        return res;
     }
 
 }
@@ -15,10 +15,98 @@
  */
 #pragma once
 
+#include <switch.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+
 namespace util {
 
+    enum class Soc {
+        Unknown,
+        Erista,
+        Mariko,
+    };
+
+    /**
+     * Console and firmware properties, probed once at service init and
+     * read only afterwards, so any thread can use them without locking.
+     * Only bpc_ams is filled in later, it is atomic for that.
+     */
+    struct Capabilities {
+        SetSysProductModel model;
+        Soc soc;
+
+        /* Zero if not running on Atmosphère. */
+        u8 ams_major;
+        u8 ams_minor;
+        u8 ams_micro;
+
+        /**
+         * Whether a bpc:ams session was opened, set by the session the payload code
+         * opens on preload or reboot. The probe does not connect itself, while sm is
+         * held that could take the only service slot. False only means not yet known.
+         */
+        std::atomic<bool> bpc_ams;
+    };
+
+    /* Needs setsys and spl, call before starting any other thread. */
+    void ProbeCapabilities();
+    Capabilities const &GetCapabilities();
+
+    /* Called once a bpc:ams session is open. */
+    void RecordBpcAms();
+
     bool IsErista();
     bool IsMariko(); // custom addition
     bool SupportsMarikoRebootToConfig();
 
+    /**
+     * Tick based stopwatch, used to profile the menu startup stages
+     * when building with PROFILE=1.
+     */
+    class Stopwatch {
+      private:
+        u64 start;
+
+      public:
+        Stopwatch() : start(armGetSystemTick()) { }
+
+        u64 ElapsedUs() const {
+            return armTicksToNs(armGetSystemTick() - start) / 1000;
+        }
+
+        void Reset() {
+            start = armGetSystemTick();
+        }
+    };
+
+    /**
+     * Records the latency and resulting entry count of consecutive stages.
+     */
+    class StageProfile {
+      private:
+        struct Stage {
+            char const *name;
+            u64 us;
+            std::size_t entries;
+        };
+
+        std::array<Stage, 8> stages = {};
+        std::size_t count = 0;
+        Stopwatch watch;
+
+      public:
+        void Mark(char const *name, std::size_t const entries) {
+            if (count < stages.size())
+                stages[count++] = { name, watch.ElapsedUs(), entries };
+
+            watch.Reset();
+        }
+
+        std::string Format() const;
+    };
+
 }
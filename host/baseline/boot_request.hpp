@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <boot_request.hpp>
+#include <payload.hpp>
+
+#include <cstring>
+
+/*
+ * How the Reboot* functions of payload.cpp filled the boot storage and the RTC
+ * reboot reason before BootRequest, one function per reason.
+ */
+namespace BaselineBootRequest {
+
+    using namespace Payload;
+
+    /* Reboot(): clear the boot storage in the payload, then let func configure it. */
+    template<typename ConfigureFunction>
+    void Reboot(u8 *payload, ConfigureFunction func) {
+        auto const storage = reinterpret_cast<BootStorage *>(payload + BootStorageOffset);
+        std::memset(storage, 0, sizeof(BootStorage));
+        func(storage);
+    }
+
+    inline void HekateStorage(u8 *payload) {
+        Reboot(payload, [&] (BootStorage *storage) {
+            /* No-Op */
+        });
+    }
+
+    inline Max77620Rtc::rtc_reboot_reason_t HekateRtc() {
+        Max77620Rtc::rtc_reboot_reason_t rr {.dec = {
+            .reason = Max77620Rtc::REBOOT_REASON_NOP,
+        }};
+        return rr;
+    }
+
+    inline void ConfigStorage(u8 *payload, std::size_t const index, bool const autoboot_list) {
+        Reboot(payload, [&] (BootStorage *storage) {
+            /* Force autoboot and set boot id. */
+            storage->boot_cfg      = BootCfg_ForceAutoBoot;
+            storage->autoboot      = index;
+            storage->autoboot_list = autoboot_list;
+        });
+    }
+
+    inline Max77620Rtc::rtc_reboot_reason_t ConfigRtc(std::size_t const index, bool const autoboot_list) {
+        Max77620Rtc::rtc_reboot_reason_t rr {.dec = {
+            .reason = Max77620Rtc::REBOOT_REASON_SELF,
+            .autoboot_idx = static_cast<u16>(index & 0xf),
+            .autoboot_list = autoboot_list,
+        }};
+        return rr;
+    }
+
+    inline void UmsStorage(u8 *payload, UmsTarget const target) {
+        Reboot(payload, [&] (BootStorage *storage) {
+            /* Force boot to menu, target UMS and select target. */
+            storage->boot_cfg  = BootCfg_ForceAutoBoot;
+            storage->extra_cfg = ExtraCfg_NyxUms;
+            storage->autoboot  = 0;
+            storage->ums       = target;
+        });
+    }
+
+    inline Max77620Rtc::rtc_reboot_reason_t UmsRtc(UmsTarget const target) {
+        Max77620Rtc::rtc_reboot_reason_t rr {.dec = {
+            .reason = Max77620Rtc::REBOOT_REASON_UMS,
+            .ums_idx = target,
+        }};
+        return rr;
+    }
+
+    inline void MenuStorage(u8 *payload) {
+        Reboot(payload, [&] (BootStorage *storage) {
+            /* Force boot to menu */
+            storage->boot_cfg  = BootCfg_ForceAutoBoot;
+            storage->autoboot  = 0;
+        });
+    }
+
+    inline Max77620Rtc::rtc_reboot_reason_t MenuRtc() {
+        Max77620Rtc::rtc_reboot_reason_t rr {.dec = {
+            .reason = Max77620Rtc::REBOOT_REASON_MENU,
+        }};
+        return rr;
+    }
+
+    /* Recovery and panic only ever went through the RTC. */
+    inline Max77620Rtc::rtc_reboot_reason_t ReasonRtc(u16 const reason) {
+        Max77620Rtc::rtc_reboot_reason_t rr {.dec = {
+            .reason = reason,
+        }};
+        return rr;
+    }
+
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2018-2020 Atmosphère-NX
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "reboot_to_payload.h"
+
+#include <string.h>
+#include <switch.h>
+
+#define IRAM_PAYLOAD_MAX_SIZE 0x24000
+#define IRAM_PAYLOAD_BASE 0x40010000
+
+alignas(0x1000) u8 g_reboot_payload[IRAM_PAYLOAD_MAX_SIZE];
+static alignas(0x1000) u8 g_ff_page[0x1000];
+static alignas(0x1000) u8 g_work_page[0x1000];
+
+static void do_iram_dram_copy(void *buf, uintptr_t iram_addr, size_t size, int option) {
+    memcpy(g_work_page, buf, size);
+
+    SecmonArgs args = {0};
+    args.X[0]       = 0xF0000201;             /* smcAmsIramCopy */
+    args.X[1]       = (uintptr_t)g_work_page; /* DRAM Address */
+    args.X[2]       = iram_addr;              /* IRAM Address */
+    args.X[3]       = size;                   /* Copy size */
+    args.X[4]       = option;                 /* 0 = Read, 1 = Write */
+    svcCallSecureMonitor(&args);
+
+    memcpy(buf, g_work_page, size);
+}
+
+static void copy_to_iram(uintptr_t iram_addr, void *buf, size_t size) {
+    do_iram_dram_copy(buf, iram_addr, size, 1);
+}
+
+static void clear_iram(void) {
+    memset(g_ff_page, 0xFF, sizeof(g_ff_page));
+    for (size_t i = 0; i < IRAM_PAYLOAD_MAX_SIZE; i += sizeof(g_ff_page)) {
+        copy_to_iram(IRAM_PAYLOAD_BASE + i, g_ff_page, sizeof(g_ff_page));
+    }
+}
+
+void smc_reboot_to_payload(void) {
+    clear_iram();
+
+    for (size_t i = 0; i < IRAM_PAYLOAD_MAX_SIZE; i += 0x1000) {
+        copy_to_iram(IRAM_PAYLOAD_BASE + i, &g_reboot_payload[i], 0x1000);
+    }
+
+    splSetConfig((SplConfigItem)65001, 2);
+}
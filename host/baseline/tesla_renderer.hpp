@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <switch.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/*
+ * The per pixel drawing of the libtesla Renderer before the span kernels, taken
+ * from tesla.hpp with the framebuffer, the frame clip and the scissor passed in.
+ * Every pixel is clipped, swizzled and blended on its own.
+ */
+class BaselineRenderer {
+    public:
+        struct Color {
+            union {
+                struct {
+                    u16 r: 4, g: 4, b: 4, a: 4;
+                } __attribute__((packed));
+                u16 rgba;
+            };
+
+            constexpr inline Color(u16 raw): rgba(raw) {}
+        };
+
+        struct Clip {
+            s32 x, y, w, h;
+        };
+
+        BaselineRenderer(u16 *framebuffer, Clip const frame_clip, Clip const scissor, s32 const width, s32 const height)
+            : m_framebuffer(framebuffer), m_frameClip(frame_clip), m_scissor(scissor), m_width(width), m_height(height) { }
+
+        static inline u8 blendColor(const u8 src, const u8 dst, const u8 alpha) {
+            return (dst * alpha + src * (0x0F - alpha)) >> 4;
+        }
+
+        static inline u16 blendDst(const u16 dst, const Color& color) {
+            Color src(dst);
+
+            Color end(0);
+            end.r = blendColor(src.r, color.r, color.a);
+            end.g = blendColor(src.g, color.g, color.a);
+            end.b = blendColor(src.b, color.b, color.a);
+            end.a = color.a + (src.a * (0xF - color.a) / 0xF);
+
+            return end.rgba;
+        }
+
+        inline u32 getPixelOffset(const s32 x, const s32 y) {
+            if (x < m_frameClip.x || y < m_frameClip.y ||
+                x >= m_frameClip.x + m_frameClip.w ||
+                y >= m_frameClip.y + m_frameClip.h) {
+                return UINT32_MAX;
+            }
+
+            if (x < m_scissor.x || y < m_scissor.y ||
+                x >= m_scissor.x + m_scissor.w ||
+                y >= m_scissor.y + m_scissor.h) {
+                return UINT32_MAX;
+            }
+
+            return (((y & 127) / 16) + ((x / 32) * 8) + ((y / 128) * 112))*512 +
+                    ((y % 16) / 8) * 256 +
+                    ((x % 32) / 16) * 128 +
+                    ((y % 8) / 2) * 32 +
+                    ((x % 16) / 8) * 16 +
+                    (y % 2) * 8 +
+                    (x % 8);
+        }
+
+        inline void setPixel(const s32 x, const s32 y, const Color& color, const u32 offset) {
+            if (x < m_width && y < m_height) {
+                if (offset != UINT32_MAX)
+                    m_framebuffer[offset] = color.rgba;
+            }
+        }
+
+        inline void setPixelBlendDst(const s32 x, const s32 y, const Color& color) {
+            u32 offset = this->getPixelOffset(x, y);
+            if (offset == UINT32_MAX)
+                return;
+
+            this->setPixel(x, y, this->blendDst(m_framebuffer[offset], color), offset);
+        }
+
+        inline void drawRect(const s32 x, const s32 y, const s32 w, const s32 h, const Color& color) {
+            s32 x_end = x + w;
+            s32 y_end = y + h;
+
+            for (s32 yi = y; yi < y_end; ++yi) {
+                for (s32 xi = x; xi < x_end; ++xi) {
+                    this->setPixelBlendDst(xi, yi, color);
+                }
+            }
+        }
+
+        /* A horizontal run the way drawCircle and the rounded rectangles drew it. */
+        inline void drawSpanBlendDst(const s32 x, const s32 y, const s32 w, const Color& color) {
+            for (s32 xi = x; xi < x + w; ++xi)
+                this->setPixelBlendDst(xi, y, color);
+        }
+
+        /* One bitmap row of the glyph loop in drawString. */
+        inline void drawGlyphRow(const s32 xPos, const s32 yPos, const u8 *glyphRow, const s32 width, const Color& color) {
+            for (s32 bmpX = 0; bmpX < width; ++bmpX) {
+                u8 bmpColor = glyphRow[bmpX] >> 4;
+                if (bmpColor == 0xF) {
+                    this->setPixel(xPos + bmpX, yPos, color, this->getPixelOffset(xPos + bmpX, yPos));
+                } else if (bmpColor != 0x0) {
+                    Color tmpColor = color;
+                    tmpColor.a = bmpColor;
+                    this->setPixelBlendDst(xPos + bmpX, yPos, tmpColor);
+                }
+            }
+        }
+
+        /*
+         * The threading of drawRoundedRectMultiThreaded: the global threads started and
+         * joined for every call, taking 4 rows at a time through a shared counter.
+         */
+        template<typename Chunk>
+        static inline void runThreaded(std::vector<std::thread>& threads, const s32 y, const s32 y_end, Chunk&& processChunk) {
+            std::atomic<s32> currentRow = y;
+
+            auto threadTask = [&]() {
+                s32 startRow;
+                while (true) {
+                    startRow = currentRow.fetch_add(4);
+                    if (startRow >= y_end) break;
+                    processChunk(startRow, std::min(startRow + 4, y_end));
+                }
+            };
+
+            for (unsigned i = 0; i < threads.size(); ++i) {
+                threads[i] = std::thread(threadTask);
+            }
+
+            for (auto& t : threads) {
+                if (t.joinable()) t.join();
+            }
+        }
+
+    private:
+        u16 *m_framebuffer;
+        Clip m_frameClip;
+        Clip m_scissor;
+        s32 m_width;
+        s32 m_height;
+};
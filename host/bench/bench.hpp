@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "../harness/harness.hpp"
+
+#include <cstddef>
+
+namespace Bench {
+
+    struct Options {
+        Harness::TreeShape shape;
+        std::size_t runs;
+    };
+
+    /* Boot entry discovery on a synthetic SD card: hekate_ipl.ini, ini folder, index and payloads. */
+    void Discovery(Options const &options);
+
+    /* Payload folder enumeration with thousands of files, against chdir and substr. */
+    void Directory(Options const &options);
+
+    /* hekate_ipl.ini tokenizing in lines per second, against the inih based parser it replaced. */
+    void IniParser(Options const &options);
+
+    /* Time from pressing A to the payload handover on erista, with and without preload. */
+    void Reboot(Options const &options);
+
+    /* crc32Calculate throughput on payload sized buffers, against a bytewise table. */
+    void Crc(Options const &options);
+
+    /* Secure monitor calls uploading the payload to IRAM, against the clear and write passes. */
+    void Iram(Options const &options);
+
+    /* I2C transactions and simulated time of the RTC reboot, against the byte by byte sequence. */
+    void Rtc(Options const &options);
+
+    /* A query typed one keystroke at a time over 10k names, narrowing the matches against a full rescan. */
+    void Filter(Options const &options);
+
+    /* libtesla rectangle, glyph and short span pixel throughput against the per pixel drawing, and damage tracked frames against full redraws. */
+    void Render(Options const &options);
+
+    /* Render jobs on the persistent worker pool, against starting the threads for every call. */
+    void Workers(Options const &options);
+
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <array>
+#include <cstdio>
+
+namespace Bench {
+
+    namespace {
+
+        constexpr auto MakeTable() {
+            std::array<u32, 256> table = {};
+
+            for (u32 i = 0; i < 256; i++) {
+                u32 crc = i;
+                for (int bit = 0; bit < 8; bit++)
+                    crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+
+                table[i] = crc;
+            }
+
+            return table;
+        }
+
+        constexpr auto Table = MakeTable();
+
+        /* One table lookup per byte, the textbook kernel as a reference. */
+        u32 BytewiseCrc32(void const *const src, std::size_t const size) {
+            auto const data = static_cast<u8 const *>(src);
+            u32 crc = ~0u;
+
+            for (std::size_t i = 0; i < size; i++)
+                crc = (crc >> 8) ^ Table[(crc ^ data[i]) & 0xFF];
+
+            return ~crc;
+        }
+
+        template<typename Kernel>
+        u32 Row(char const *name, Options const &options, std::string const &data, Kernel &&kernel) {
+            u32 crc = 0;
+            auto const sample = Harness::MeasureMedian(options.runs, [] { }, [&] { crc = kernel(data.data(), data.size()); });
+
+            std::printf("  %-28s %8zu %10.1f %10.1f   %08x\n", name, data.size(), sample.ns / 1000.0, sample.ns ? data.size() * 1000.0 / sample.ns : 0.0, crc);
+            return crc;
+        }
+
+    }
+
+    void Crc(Options const &options) {
+        std::printf("\ncrc: payload checksum kernel, median of %zu runs\n", options.runs);
+        std::printf("  %-28s %8s %10s %10s   %8s\n", "stage", "bytes", "us", "MB/s", "crc");
+
+        /* A small payload, the configured one and the largest that fits IRAM. */
+        for (std::size_t const size : { std::size_t(0x4000), options.shape.payload_size, std::size_t(0x24000) }) {
+            auto const data = Harness::MakePayload(size, static_cast<u32>(size), false);
+
+            auto const reference = Row("bytewise table", options, data, BytewiseCrc32);
+            auto const crc       = Row("crc32Calculate", options, data, crc32Calculate);
+
+            if (crc != reference)
+                std::printf("  crc32Calculate disagrees with the reference\n");
+        }
+    }
+
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <mock.hpp>
+#include <directory.hpp>
+
+#include <dirent.h>
+#include <unistd.h>
+#include <cstdio>
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Bench {
+
+    namespace {
+
+        constexpr char const *const PayloadDir = "sdmc:/payloads/";
+        constexpr std::size_t Threads = 4;
+
+        /* The payload folder enumeration before DirectoryListing, for comparison. */
+        struct BaselinePayload {
+            std::string name;
+            std::string path;
+        };
+
+        std::list<BaselinePayload> BaselineList(std::string const &root) {
+            std::list<BaselinePayload> res;
+
+            if (chdir(PayloadDir) != 0)
+                return res;
+
+            if (auto const dirp = opendir(".")) {
+                while (auto const dent = readdir(dirp)) {
+                    if (dent->d_type != DT_REG)
+                        continue;
+
+                    std::string const name(dent->d_name);
+                    if (name.substr(name.size() - 4) == ".bin")
+                        res.push_back({ name.substr(0, name.size() - 4), (PayloadDir + name) });
+                }
+
+                closedir(dirp);
+            }
+
+            /* Was chdir("sdmc:/"), the SD card root is a plain directory here. */
+            if (chdir(root.c_str()) != 0)
+                std::perror(root.c_str());
+
+            return res;
+        }
+
+        /* count payloads plus a quarter as many other files, created in scrambled order. */
+        void MakeFolder(std::size_t const count) {
+            Mock::SdCard::MakeDirectory(PayloadDir);
+            Mock::SdCard::MakeDirectory("sdmc:/payloads/folder.bin");
+
+            char path[FS_MAX_PATH];
+            for (std::size_t i = 0; i < count + count / 4; i++) {
+                auto const id = (i * 7919) % (count + count / 4);
+                std::snprintf(path, sizeof(path), "%s%s_%05zu.%s", PayloadDir, id < count ? "payload" : "notes", id, id < count ? "bin" : "txt");
+                Mock::SdCard::WriteFile(path, {});
+            }
+        }
+
+    }
+
+    void Directory(Options const &options) {
+        for (std::size_t const scale : { 16, 64, 256 }) {
+            Mock::SdCard const sd;
+
+            auto const count = std::max<std::size_t>(options.shape.payloads, 1) * scale;
+            MakeFolder(count);
+
+            char cwd[FS_MAX_PATH];
+            std::string const root = getcwd(cwd, sizeof(cwd)) ? cwd : ".";
+
+            char title[0x80];
+            std::snprintf(title, sizeof(title), "directory: %zu payloads and %zu other files in one folder", count, count / 4);
+            Harness::PrintHeader(title);
+
+            auto const none = [] { };
+            std::size_t entries = 0;
+
+            auto const baseline = Harness::MeasureMedian(options.runs, none, [&] {
+                entries = BaselineList(root).size();
+            });
+            Harness::PrintSample("chdir + substr (before)", baseline, entries);
+            Harness::PrintRate(baseline, entries, "entries");
+
+            auto const listing = Harness::MeasureMedian(options.runs, none, [&] {
+                entries = util::DirectoryListing(PayloadDir, ".bin").size();
+            });
+            Harness::PrintSample("DirectoryListing, sorted", listing, entries);
+            Harness::PrintRate(listing, entries, "entries");
+
+            /* Without chdir several threads may list at once. */
+            auto const parallel = Harness::MeasureMedian(options.runs, none, [&] {
+                std::size_t counts[Threads] = {};
+                std::vector<std::thread> threads;
+
+                for (auto &thread_count : counts)
+                    threads.emplace_back([&thread_count] { thread_count = util::DirectoryListing(PayloadDir, ".bin").size(); });
+
+                for (auto &thread : threads)
+                    thread.join();
+
+                entries = 0;
+                for (auto const thread_count : counts)
+                    entries += thread_count;
+            });
+            Harness::PrintSample("DirectoryListing, 4 threads", parallel, entries);
+            Harness::PrintRate(parallel, entries, "entries");
+        }
+    }
+
+}
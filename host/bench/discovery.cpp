@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <mock.hpp>
+#include <payload.hpp>
+
+#include <cstdio>
+
+namespace Bench {
+
+    namespace {
+
+        constexpr char const *const IndexPath    = "sdmc:/bootloader/quickReBoot.idx";
+        constexpr char const *const RegistryPath = "sdmc:/bootloader/quickReBoot.payloads";
+
+        template<typename List>
+        std::size_t Count(List const &list) {
+            return list.size();
+        }
+
+        std::size_t Count(Payload::BootConfigs const &configs) {
+            return configs.boot.size() + configs.ini.size();
+        }
+
+        /* Measures load, keeping the result alive until the sample was taken. */
+        template<typename Setup, typename Load>
+        void Stage(char const *name, Options const &options, Setup &&setup, Load &&load) {
+            std::size_t entries = 0;
+
+            auto const sample = Harness::MeasureMedian(options.runs, setup, [&] {
+                auto const result = load();
+                entries = Count(result);
+            });
+
+            Harness::PrintSample(name, sample, entries);
+        }
+
+    }
+
+    void Discovery(Options const &options) {
+        Mock::SdCard const sd;
+        Harness::GenerateTree(options.shape);
+
+        char title[0x100];
+        std::snprintf(title, sizeof(title), "discovery: %zu boot configs, %zu ini files x %zu configs, 3 x %zu payloads of %zu bytes, median of %zu runs",
+                      options.shape.boot_configs, options.shape.ini_files, options.shape.ini_configs, options.shape.payloads, options.shape.payload_size, options.runs);
+        Harness::PrintHeader(title);
+
+        auto const none = [] { };
+
+        Stage("LoadHekateConfigList", options, none, Payload::LoadHekateConfigList);
+        Stage("LoadIniConfigList", options, none, Payload::LoadIniConfigList);
+
+        /* Without the index every source is parsed and the index is written. */
+        Stage("LoadBootConfigs cold", options, [] { Mock::SdCard::Remove(IndexPath); }, Payload::LoadBootConfigs);
+        Stage("LoadBootConfigs indexed", options, none, Payload::LoadBootConfigs);
+
+        /* Without the registry every payload is read and checksummed. */
+        Stage("LoadPayloadList cold", options, [] { Mock::SdCard::Remove(RegistryPath); }, Payload::LoadPayloadList);
+        Stage("LoadPayloadList registered", options, none, Payload::LoadPayloadList);
+    }
+
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <name_filter.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Bench {
+
+    namespace {
+
+        constexpr std::size_t Names = 10000;
+
+        /* Typed one keystroke at a time, every prefix extends the one before. */
+        constexpr std::string_view Query = "Atmosphere 1";
+
+        /* Payload and config names as they show up in the list, in mixed case. */
+        std::vector<std::string> MakeNames() {
+            constexpr std::string_view Words[] = {
+                "hekate", "Atmosphere", "fusee", "Lockpick_RCM", "TegraExplorer", "Android", "lakka", "Ubuntu", "atmosphere-emummc", "SX OS",
+            };
+
+            std::vector<std::string> names;
+            names.reserve(Names);
+
+            for (std::size_t i = 0; i < Names; i++) {
+                auto const &word = Words[(i * 7) % std::size(Words)];
+                names.push_back(std::string(word) + ' ' + std::to_string(i) + ".bin");
+            }
+
+            return names;
+        }
+
+        /* Case insensitive substring search over every name, independent of NameFilter. */
+        std::vector<std::uint32_t> Reference(std::vector<std::string> const &names, std::string_view const query) {
+            auto const equal = [](char const lhs, char const rhs) {
+                return std::tolower(static_cast<unsigned char>(lhs)) == std::tolower(static_cast<unsigned char>(rhs));
+            };
+
+            std::vector<std::uint32_t> matches;
+            for (std::uint32_t i = 0; i < names.size(); i++) {
+                if (std::search(names[i].begin(), names[i].end(), query.begin(), query.end(), equal) != names[i].end())
+                    matches.push_back(i);
+            }
+
+            return matches;
+        }
+
+        bool Same(std::span<std::uint32_t const> const lhs, std::vector<std::uint32_t> const &rhs) {
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        }
+
+    }
+
+    void Filter(Options const &options) {
+        auto const names = MakeNames();
+
+        util::NameFilter filter;
+        for (auto const &name : names)
+            filter.Add(name);
+
+        /* Names checked over the whole query: every name per keystroke, or the previous matches. */
+        std::size_t rescan_checked = 0, narrow_checked = 0;
+        std::size_t previous = names.size();
+        bool same = true;
+
+        for (std::size_t keys = 1; keys <= Query.size(); keys++) {
+            auto const prefix = Query.substr(0, keys);
+            auto const reference = Reference(names, prefix);
+
+            filter.Set(prefix);
+            same &= Same(filter.Matches(), reference);
+
+            util::NameFilter rescan;
+            for (auto const &name : names)
+                rescan.Add(name);
+            rescan.Set(prefix);
+            same &= Same(rescan.Matches(), reference);
+
+            rescan_checked += names.size();
+            narrow_checked += previous;
+            previous = reference.size();
+        }
+
+        auto const matches = filter.Matches().size();
+
+        /* Set("") drops the query, the next Set() then starts from every name again. */
+        auto const narrow = Harness::MeasureMedian(options.runs, [&] { filter.Set(""); }, [&] {
+            for (std::size_t keys = 1; keys <= Query.size(); keys++)
+                filter.Set(Query.substr(0, keys));
+        });
+
+        auto const rescan = Harness::MeasureMedian(options.runs, [&] { filter.Set(""); }, [&] {
+            for (std::size_t keys = 1; keys <= Query.size(); keys++) {
+                filter.Set("");
+                filter.Set(Query.substr(0, keys));
+            }
+        });
+
+        std::printf("\nfilter: \"%.*s\" typed over %zu names, median of %zu runs\n", static_cast<int>(Query.size()), Query.data(), names.size(), options.runs);
+        std::printf("  %-28s %8s %10s %10s %8s\n", "stage", "checked", "us", "us/key", "matches");
+        std::printf("  %-28s %8zu %10.1f %10.2f %8zu\n", "full rescan", rescan_checked, rescan.ns / 1000.0, rescan.ns / 1000.0 / Query.size(), matches);
+        std::printf("  %-28s %8zu %10.1f %10.2f %8zu\n", "NameFilter narrowing", narrow_checked, narrow.ns / 1000.0, narrow.ns / 1000.0 / Query.size(), matches);
+
+        if (!same)
+            std::printf("  narrowing and rescan disagree with the reference\n");
+    }
+
+}
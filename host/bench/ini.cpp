@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include "../baseline/ini.h"
+
+#include <mock.hpp>
+#include <ini_parser.hpp>
+#include <payload.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <string>
+
+namespace Bench {
+
+    namespace {
+
+        constexpr char const *const HekateIniPath = "sdmc:/bootloader/hekate_ipl.ini";
+
+        /* The config list and handler before the in-place tokenizer, for comparison. */
+        struct BaselineConfig {
+            std::string name;
+            std::size_t index;
+        };
+
+        using BaselineConfigList = std::list<BaselineConfig>;
+
+        int BaselineHandler(void *user, char const *section, char const *name, char const *value) {
+            auto const list = reinterpret_cast<BaselineConfigList *>(user);
+
+            if (section[0] == '\0' || std::strcmp(section, "config") == 0)
+                return 1;
+
+            auto const it = std::find_if(list->begin(), list->end(), [section](BaselineConfig const &config) {
+                return config.name == section;
+            });
+
+            if (it == list->end())
+                list->push_back({ section, list->size() + 1 });
+
+            (void)name;
+            (void)value;
+
+            return 1;
+        }
+
+        void PrintRate(char const *name, Harness::Sample const &sample, std::size_t const lines, std::size_t const entries) {
+            Harness::PrintSample(name, sample, entries);
+            Harness::PrintRate(sample, lines, "lines");
+        }
+
+    }
+
+    void IniParser(Options const &options) {
+        Mock::SdCard const sd;
+
+        /* Scales the configured hekate_ipl.ini up to config sizes well beyond real ones. */
+        for (std::size_t const scale : { 1, 10, 100 }) {
+            auto const sections = std::max<std::size_t>(options.shape.boot_configs, 1) * scale;
+            auto const ini      = Harness::MakeIni("boot", sections, options.shape.keys);
+            auto const lines    = static_cast<std::size_t>(std::count(ini.begin(), ini.end(), '\n'));
+
+            Mock::SdCard::WriteFile(HekateIniPath, ini);
+
+            char title[0x80];
+            std::snprintf(title, sizeof(title), "ini: hekate_ipl.ini with %zu sections, %zu lines, %zu bytes", sections, lines, ini.size());
+            Harness::PrintHeader(title);
+
+            auto const none = [] { };
+            std::size_t entries = 0;
+
+            /* In memory first, so only the tokenizer and the list are compared. */
+            auto const inih_string = Harness::MeasureMedian(options.runs, none, [&] {
+                BaselineConfigList list;
+                ini_parse_string(ini.c_str(), BaselineHandler, &list);
+                entries = list.size();
+            });
+            PrintRate("inih string", inih_string, lines, entries);
+
+            auto const parse_string = Harness::MeasureMedian(options.runs, none, [&] {
+                std::size_t count = 0;
+                Ini::Parse(ini,
+                    [&count](std::string_view const section, std::size_t) { count += !section.empty() && section != "config"; },
+                    [](std::string_view, std::string_view, std::string_view) { });
+                entries = count;
+            });
+            PrintRate("Ini::Parse string", parse_string, lines, entries);
+
+            /* Whole path from the SD card to the config list. */
+            auto const inih_file = Harness::MeasureMedian(options.runs, none, [&] {
+                BaselineConfigList list;
+                ini_parse(HekateIniPath, BaselineHandler, &list);
+                entries = list.size();
+            });
+            PrintRate("inih file", inih_file, lines, entries);
+
+            auto const load_file = Harness::MeasureMedian(options.runs, none, [&] {
+                entries = Payload::LoadHekateConfigList().size();
+            });
+            PrintRate("LoadHekateConfigList", load_file, lines, entries);
+        }
+    }
+
+}
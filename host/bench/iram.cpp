@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <mock.hpp>
+#include <reboot_to_payload.h>
+
+#define g_reboot_payload baseline_reboot_payload
+#define smc_reboot_to_payload baseline_smc_reboot_to_payload
+#include "../baseline/reboot_to_payload.h"
+#undef g_reboot_payload
+#undef smc_reboot_to_payload
+
+#include <cstdio>
+#include <cstring>
+
+namespace Bench {
+
+    namespace {
+
+        template<typename Upload>
+        void Row(char const *name, Options const &options, Upload &&upload) {
+            auto const sample = Harness::MeasureMedian(options.runs, [] { Mock::Reset(); }, upload);
+            auto const stats  = Mock::Smc();
+
+            std::printf("  %-28s %10.1f %6u %8llu %8u\n", name, sample.ns / 1000.0, stats.calls, static_cast<unsigned long long>(stats.bytes), stats.invalid);
+        }
+
+    }
+
+    void Iram(Options const &options) {
+        auto const size    = std::min<std::size_t>(options.shape.payload_size, IRAM_PAYLOAD_MAX_SIZE);
+        auto const payload = Harness::MakePayload(size, 0, true);
+
+        for (auto const buffer : { g_reboot_payload, baseline_reboot_payload }) {
+            std::memset(buffer, 0xFF, IRAM_PAYLOAD_MAX_SIZE);
+            std::memcpy(buffer, payload.data(), size);
+        }
+
+        std::printf("\niram: upload of a %zu byte payload through the simulated secure monitor, median of %zu runs\n", size, options.runs);
+        std::printf("  %-28s %10s %6s %8s %8s\n", "stage", "us", "smc", "bytes", "invalid");
+
+        Row("before: clear, then write", options, [] { baseline_smc_reboot_to_payload(); });
+        Row("one pass, no bounce", options, [size] { smc_reboot_to_payload(size); });
+    }
+
+}
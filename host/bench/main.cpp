@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <util.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+    struct Suite {
+        std::string_view name;
+        void (*run)(Bench::Options const &options);
+    };
+
+    constexpr Suite Suites[] = {
+        { "discovery", Bench::Discovery },
+        { "ini", Bench::IniParser },
+        { "directory", Bench::Directory },
+        { "reboot", Bench::Reboot },
+        { "rtc", Bench::Rtc },
+        { "iram", Bench::Iram },
+        { "crc", Bench::Crc },
+        { "filter", Bench::Filter },
+        { "render", Bench::Render },
+        { "workers", Bench::Workers },
+    };
+
+    void Usage(char const *program) {
+        std::printf("usage: %s [options] [suite...]\n", program);
+        std::printf("  --boot N          sections in hekate_ipl.ini\n");
+        std::printf("  --inis N          files in bootloader/ini\n");
+        std::printf("  --ini-configs N   sections per ini file\n");
+        std::printf("  --keys N          keys per section\n");
+        std::printf("  --payloads N      payloads per payload folder\n");
+        std::printf("  --payload-size N  bytes per payload\n");
+        std::printf("  --runs N          runs per stage, the median is reported\n");
+        std::printf("suites:");
+
+        for (auto const &suite : Suites)
+            std::printf(" %.*s", static_cast<int>(suite.name.size()), suite.name.data());
+
+        std::printf("\n");
+    }
+
+}
+
+/**
+ * Host benchmarks, built with Makefile.host. Numbers come from the host file system
+ * with a warm page cache, so they are for comparing changes, not console timings.
+ * The fs call and allocation counts match the console.
+ */
+int main(int const argc, char const *argv[]) {
+    Bench::Options options = {
+        .shape = {
+            .boot_configs = 32,
+            .ini_files    = 64,
+            .ini_configs  = 8,
+            .keys         = 6,
+            .payloads     = 64,
+            .payload_size = 0x20000,
+        },
+        .runs = 9,
+    };
+
+    struct {
+        char const *name;
+        std::size_t *value;
+    } const flags[] = {
+        { "--boot", &options.shape.boot_configs },
+        { "--inis", &options.shape.ini_files },
+        { "--ini-configs", &options.shape.ini_configs },
+        { "--keys", &options.shape.keys },
+        { "--payloads", &options.shape.payloads },
+        { "--payload-size", &options.shape.payload_size },
+        { "--runs", &options.runs },
+    };
+
+    bool selected[std::size(Suites)] = {};
+    bool any_selected = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view const arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            Usage(argv[0]);
+            return 0;
+        }
+
+        bool matched = false;
+        for (auto const &flag : flags) {
+            if (arg == flag.name && i + 1 < argc) {
+                *flag.value = std::strtoull(argv[++i], nullptr, 0);
+                matched = true;
+            }
+        }
+
+        for (std::size_t suite = 0; suite < std::size(Suites); suite++) {
+            if (arg == Suites[suite].name) {
+                selected[suite] = any_selected = matched = true;
+            }
+        }
+
+        if (!matched) {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.runs == 0)
+        options.runs = 1;
+
+    util::ProbeCapabilities();
+
+    for (std::size_t suite = 0; suite < std::size(Suites); suite++) {
+        if (!any_selected || selected[suite])
+            Suites[suite].run(options);
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <mock.hpp>
+#include <payload.hpp>
+#include <reboot_to_payload.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace Bench {
+
+    namespace {
+
+        constexpr char const *const HekatePaths[] = {
+            "sdmc:/atmosphere/reboot_payload.bin",
+            "sdmc:/bootloader/update.bin",
+            "sdmc:/bootloader/payloads/hekate.bin",
+            "sdmc:/sept/payload.bin",
+        };
+
+        /* Stands in for g_reboot_payload, so the baseline leaves the preloaded one alone. */
+        u8 g_baseline_payload[IRAM_PAYLOAD_MAX_SIZE];
+
+        /* LoadHekatePayload before the cache, which ran on every reboot, for comparison. */
+        bool BaselineLoadHekatePayload() {
+            for (auto const path : HekatePaths) {
+                std::memset(g_baseline_payload, 0xFF, sizeof(g_baseline_payload));
+
+                auto const file = fopen(path, "r");
+                if (file == nullptr)
+                    continue;
+
+                auto const ret = fread(g_baseline_payload, 1, sizeof(g_baseline_payload), file);
+                fclose(file);
+
+                if (ret != 0 && *(u32 *)(g_baseline_payload + Payload::MagicOffset) == Payload::Magic)
+                    return true;
+            }
+
+            return false;
+        }
+
+    }
+
+    void Reboot(Options const &options) {
+        Mock::SdCard const sd;
+        Mock::SetProductModel(SetSysProductModel_Nx);
+
+        /* A fusee reboot_payload.bin is probed before hekate, like on many erista setups. */
+        auto const size = std::min<std::size_t>(options.shape.payload_size, IRAM_PAYLOAD_MAX_SIZE);
+        Mock::SdCard::WriteFile(HekatePaths[0], Harness::MakePayload(size, 1, false));
+        Mock::SdCard::WriteFile(HekatePaths[1], Harness::MakePayload(size, 2, true));
+
+        char title[0x80];
+        std::snprintf(title, sizeof(title), "reboot: erista, hekate in %s, %zu byte payloads", HekatePaths[1], size);
+        Harness::PrintHeader(title);
+
+        auto const none = [] { };
+        s64 mtime = 1000;
+        bool ok = true;
+
+        auto const baseline = Harness::MeasureMedian(options.runs, none, [&] { ok &= BaselineLoadHekatePayload(); });
+        Harness::PrintSample("before: probe on every A", baseline, ok);
+
+        /* Touching the payload makes the cache stale, which is a reboot without preload. */
+        auto const cold = Harness::MeasureMedian(options.runs, [&] { Mock::SdCard::Touch(HekatePaths[1], mtime++); }, [&] {
+            ok &= Payload::RebootToHekate();
+        });
+        Harness::PrintSample("RebootToHekate, cold", cold, ok);
+
+        auto const preloaded = Harness::MeasureMedian(options.runs, [&] {
+            Mock::SdCard::Touch(HekatePaths[1], mtime++);
+            Payload::PreloadHekatePayload();
+        }, [&] {
+            ok &= Payload::RebootToHekate();
+        });
+        Harness::PrintSample("RebootToHekate, preloaded", preloaded, ok);
+
+        if (!ok)
+            std::printf("  a reboot failed to load hekate\n");
+    }
+
+}
@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include "../baseline/tesla_renderer.hpp"
+#include "../harness/span_renderer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace Bench {
+
+    namespace {
+
+        /* The overlay framebuffer, allocated with the height rounded up to whole blocks. */
+        constexpr s32 Width  = 448;
+        constexpr s32 Height = 720;
+        constexpr std::size_t Pixels = Width * ((Height + 127) & ~127);
+
+        /* Half transparent, so every pixel goes through the blend. */
+        constexpr u16 FillColor = 0x7A3C;
+        constexpr u16 TextColor = 0xFFFF;
+
+        /* Glyph cell of the default font size, with coverage ramps like anti-aliased edges. */
+        constexpr s32 GlyphWidth  = 11;
+        constexpr s32 GlyphHeight = 20;
+
+        struct Frame {
+            std::vector<u16> pixels = std::vector<u16>(Pixels);
+
+            void Clear() {
+                u32 seed = 1;
+                for (auto &pixel : pixels) {
+                    seed = seed * 1664525 + 1013904223;
+                    pixel = seed >> 16;
+                }
+            }
+
+            u32 Checksum() const {
+                return crc32Calculate(pixels.data(), pixels.size() * sizeof(u16));
+            }
+        };
+
+        /* A primitive drawn by both renderers, draw(renderer) returns the pixels it touched. */
+        template<typename Draw>
+        void Primitive(char const *name, Options const &options, Draw &&draw) {
+            Frame frame;
+            BaselineRenderer baseline(frame.pixels.data(), { 0, 0, Width, Height }, { 0, 0, Width, Height }, Width, Height);
+            Harness::SpanRenderer span(frame.pixels.data(), { 0, 0, Width, Height }, { 0, 0, Width, Height });
+
+            u32 checksums[2] = {};
+            std::size_t pixels = 0;
+
+            auto const row = [&](char const *stage, auto &renderer, u32 &checksum) {
+                auto const sample = Harness::MeasureMedian(options.runs, [&] { frame.Clear(); }, [&] { pixels = draw(renderer); });
+                checksum = frame.Checksum();
+
+                std::printf("  %-14s %-14s %8zu %10.1f %10.1f   %08x\n", name, stage, pixels, sample.ns / 1000.0, sample.ns ? pixels * 1000.0 / sample.ns : 0.0, checksum);
+            };
+
+            row("per pixel", baseline, checksums[0]);
+            row("spans", span, checksums[1]);
+
+            if (checksums[0] != checksums[1])
+                std::printf("  the spans disagree with the per pixel drawing\n");
+        }
+
+        struct Rect {
+            s32 x, y, w, h;
+        };
+
+        namespace render = tsl::gfx::render;
+
+        /* The list layout of the overlay: header band, items, footer band. */
+        constexpr s32 HeaderHeight    = 97;
+        constexpr s32 FooterHeight    = 73;
+        constexpr s32 ItemX           = 19;
+        constexpr s32 ItemWidth       = Width - 2 * ItemX;
+        constexpr s32 ItemHeight      = 70;
+        constexpr s32 Items           = (Height - HeaderHeight - FooterHeight) / ItemHeight;
+        constexpr s32 HighlightMargin = 16;    /* Element::HighlightMargin */
+
+        constexpr u16 BackgroundColor = 0xD000;
+        constexpr u16 BarColor        = 0xF222;
+        constexpr u16 FocusColor      = 0xA511;
+
+        /* One second at 60 Hz. */
+        constexpr std::size_t Frames = 60;
+
+        struct Scene {
+            char const *name;
+            s32 focus;          /* Focused item before the measured frames, -1 for none. */
+            s32 next_focus;     /* Focused item after the input of the first measured frame. */
+            bool input;
+        };
+
+        /* The two swapchain framebuffers of one path and what it drew. */
+        struct Swapchain {
+            std::vector<u16> buffers[2] = { std::vector<u16>(Pixels), std::vector<u16>(Pixels) };
+            render::FrameDamage damage;
+            render::FrameDamage::Stats full = {};
+            u32 slot = 0;
+            u32 presented = 0;
+            std::size_t frame = 0;
+            s32 focus = -1;
+
+            u32 Checksum() const {
+                return crc32Calculate(buffers[presented].data(), Pixels * sizeof(u16));
+            }
+        };
+
+        bool Overlaps(render::Rect const &clip, s32 const x, s32 const y, s32 const w, s32 const h) {
+            return x < clip.x + clip.w && x + w > clip.x && y < clip.y + clip.h && y + h > clip.y;
+        }
+
+        /*
+         * One frame of the overlay list, drawn like Gui::draw into the frame clip. The focused item
+         * marks itself for the next frame, because its highlight is animated, and the list skips
+         * items outside the clip.
+         */
+        void DrawScene(Swapchain &chain, u16 *framebuffer, render::Rect const &clip, std::vector<u8> const &glyph) {
+            Harness::SpanRenderer renderer(framebuffer, { clip.x, clip.y, clip.w, clip.h }, { 0, 0, Width, Height });
+
+            /* fillScreen, only the damaged rows. */
+            for (s32 y = clip.y; y < clip.y + clip.h; y++) {
+                renderer.forEachSpanGroup(clip.x, y, clip.w, [](u16 *pixels, s32, s32 count) {
+                    std::fill_n(pixels, count, BackgroundColor);
+                });
+            }
+
+            auto const text = [&](s32 const x, s32 const y, s32 const glyphs) {
+                for (s32 i = 0; i < glyphs; i++) {
+                    for (s32 bmpY = 0; bmpY < GlyphHeight; bmpY++)
+                        renderer.drawGlyphRow(x + i * GlyphWidth, y + bmpY, glyph.data() + bmpY * GlyphWidth, GlyphWidth, TextColor);
+                }
+            };
+
+            renderer.drawRect(0, 0, Width, HeaderHeight, BarColor);
+            text(20, 40, 16);
+            renderer.drawRect(0, Height - FooterHeight, Width, FooterHeight, BarColor);
+            text(30, Height - 50, 10);
+
+            for (s32 item = 0; item < Items; item++) {
+                s32 const y = HeaderHeight + item * ItemHeight;
+
+                if (!Overlaps(clip, ItemX - HighlightMargin, y - HighlightMargin, ItemWidth + 2 * HighlightMargin, ItemHeight + 2 * HighlightMargin))
+                    continue;
+
+                if (item == chain.focus) {
+                    chain.damage.mark({ ItemX - HighlightMargin, y - HighlightMargin, ItemWidth + 2 * HighlightMargin, ItemHeight + 2 * HighlightMargin });
+
+                    /* Focus background and a 4 pixel border pulsing with the frame count, scissored to the list. */
+                    Harness::SpanRenderer highlight(framebuffer, { clip.x, clip.y, clip.w, clip.h }, { 0, HeaderHeight, Width, Height - FooterHeight - HeaderHeight });
+                    u16 const border = 0xF0F0 | ((chain.frame % 16) << 8);
+
+                    highlight.drawRect(ItemX, y, ItemWidth, ItemHeight, FocusColor);
+                    highlight.drawRect(ItemX - 4, y - 4, ItemWidth + 8, 4, border);
+                    highlight.drawRect(ItemX - 4, y + ItemHeight, ItemWidth + 8, 4, border);
+                    highlight.drawRect(ItemX - 4, y, 4, ItemHeight, border);
+                    highlight.drawRect(ItemX + ItemWidth, y, 4, ItemHeight, border);
+                }
+
+                text(ItemX + 19, y + 25, 12 + item);
+                renderer.drawRect(ItemX, y + ItemHeight - 1, ItemWidth, 1, 0x5FFF);
+            }
+        }
+
+        /* Gui loop with startDamagedFrame: skip without damage, otherwise draw the damage of the dequeued framebuffer. */
+        void DamagedFrame(Swapchain &chain, std::vector<u8> const &glyph) {
+            chain.frame++;
+
+            if (!chain.damage.collect())
+                return;
+
+            u32 const slot = chain.slot;
+            chain.slot ^= 1;
+            chain.presented = slot;
+
+            auto const clip = chain.damage.take(slot, Width, Height);
+            if (clip.w == 0 || clip.h == 0)
+                return;
+
+            DrawScene(chain, chain.buffers[slot].data(), clip, glyph);
+        }
+
+        /* Gui loop with startFrame: every frame redraws the whole framebuffer. */
+        void FullFrame(Swapchain &chain, std::vector<u8> const &glyph) {
+            chain.frame++;
+
+            u32 const slot = chain.slot;
+            chain.slot ^= 1;
+            chain.presented = slot;
+
+            DrawScene(chain, chain.buffers[slot].data(), { 0, 0, Width, Height }, glyph);
+            chain.full.frames++;
+            chain.full.pixels += Width * Height;
+        }
+
+        /* Both framebuffers drawn once, then the first measured frame handles the input. */
+        void StartScene(Swapchain &chain, Scene const &scene, bool const damaged, std::vector<u8> const &glyph) {
+            chain = Swapchain();
+            chain.focus = scene.focus;
+
+            chain.damage.mark({ 0, 0, Width, Height });
+            for (int i = 0; i < 2; i++)
+                damaged ? DamagedFrame(chain, glyph) : FullFrame(chain, glyph);
+
+            if (scene.input) {
+                chain.damage.mark({ 0, 0, Width, Height });    /* handleInput marks the whole screen. */
+                chain.focus = scene.next_focus;
+            }
+        }
+
+        /* Counters of the measured frames only. */
+        render::FrameDamage::Stats Since(render::FrameDamage::Stats const &now, render::FrameDamage::Stats const &before) {
+            return { now.frames - before.frames, now.skippedFrames - before.skippedFrames, now.pixels - before.pixels };
+        }
+
+        void Damage(Options const &options, std::vector<u8> const &glyph) {
+            std::printf("\nrender: damage tracking against full redraws, %zu frames of the overlay list, median of %zu runs\n", Frames, options.runs);
+            std::printf("  %-14s %-14s %8s %8s %10s %10s   %8s\n", "frames", "stage", "drawn", "skipped", "pixels", "us/frame", "crc");
+
+            for (Scene const scene : { Scene{ "idle", -1, -1, false }, Scene{ "idle focused", 2, 2, false }, Scene{ "focus change", 2, 3, true } }) {
+                Swapchain damaged, full;
+
+                /* Every presented frame of the damage path has to look like the full redraw. */
+                StartScene(damaged, scene, true, glyph);
+                StartScene(full, scene, false, glyph);
+                auto const before = damaged.damage.stats();
+                auto const full_before = full.full;
+
+                std::size_t mismatches = 0;
+                for (std::size_t i = 0; i < Frames; i++) {
+                    DamagedFrame(damaged, glyph);
+                    FullFrame(full, glyph);
+                    mismatches += damaged.Checksum() != full.Checksum();
+                }
+
+                auto const stats = Since(damaged.damage.stats(), before);
+                auto const full_stats = Since(full.full, full_before);
+
+                auto const row = [&](char const *stage, bool const use_damage, render::FrameDamage::Stats const &counters, u32 const checksum) {
+                    Swapchain chain;
+                    auto const sample = Harness::MeasureMedian(options.runs, [&] { StartScene(chain, scene, use_damage, glyph); }, [&] {
+                        for (std::size_t i = 0; i < Frames; i++)
+                            use_damage ? DamagedFrame(chain, glyph) : FullFrame(chain, glyph);
+                    });
+
+                    std::printf("  %-14s %-14s %8llu %8llu %10llu %10.1f   %08x\n", scene.name, stage, static_cast<unsigned long long>(counters.frames),
+                                static_cast<unsigned long long>(counters.skippedFrames), static_cast<unsigned long long>(counters.pixels), sample.ns / 1000.0 / Frames, checksum);
+                };
+
+                row("full redraw", false, full_stats, full.Checksum());
+                row("damage", true, stats, damaged.Checksum());
+
+                if (mismatches)
+                    std::printf("  %zu presented frames of the damage path differ from the full redraw\n", mismatches);
+            }
+        }
+
+    }
+
+    void Render(Options const &options) {
+        std::printf("\nrender: libtesla primitives on a %dx%d RGBA4444 framebuffer, scalar kernels, median of %zu runs\n", Width, Height, options.runs);
+        std::printf("  %-14s %-14s %8s %10s %10s   %8s\n", "primitive", "stage", "pixels", "us", "Mpixel/s", "crc");
+
+        std::vector<u8> glyph(GlyphWidth * GlyphHeight);
+        for (std::size_t i = 0; i < glyph.size(); i++)
+            glyph[i] = (i % 3 == 0) ? 0xFF : static_cast<u8>(i * 53);
+
+        /* Backgrounds and list item highlights, the latter starting off a group. */
+        for (Rect const rect : { Rect{ 0, 0, Width, Height }, Rect{ 13, 97, 400, 70 } }) {
+            char name[0x20];
+            std::snprintf(name, sizeof(name), "rect %dx%d", rect.w, rect.h);
+
+            Primitive(name, options, [&rect](auto &renderer) {
+                renderer.drawRect(rect.x, rect.y, rect.w, rect.h, FillColor);
+                return static_cast<std::size_t>(rect.w * rect.h);
+            });
+        }
+
+        /* A screen of text, 38 glyphs per line at every column offset. */
+        Primitive("glyphs", options, [&glyph](auto &renderer) {
+            std::size_t pixels = 0;
+
+            for (s32 y = 0; y + GlyphHeight <= Height; y += GlyphHeight + 4) {
+                for (s32 x = 5; x + GlyphWidth <= Width; x += GlyphWidth) {
+                    for (s32 bmpY = 0; bmpY < GlyphHeight; bmpY++)
+                        renderer.drawGlyphRow(x, y + bmpY, glyph.data() + bmpY * GlyphWidth, GlyphWidth, TextColor);
+
+                    pixels += GlyphWidth * GlyphHeight;
+                }
+            }
+
+            return pixels;
+        });
+
+        /* Circle and rounded corner edges, runs below BlendDstTablesMinWidth. */
+        Primitive("short spans", options, [](auto &renderer) {
+            std::size_t pixels = 0;
+
+            for (s32 y = 0; y < Height; y++) {
+                for (s32 x = 0, w = 1 + y % 15; x + w <= Width; x += w + 9) {
+                    renderer.drawSpanBlendDst(x, y, w, FillColor);
+                    pixels += w;
+                }
+            }
+
+            return pixels;
+        });
+
+        Damage(options, glyph);
+    }
+
+}
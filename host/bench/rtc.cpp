@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <mock.hpp>
+#include <rtc_r2p.hpp>
+
+#define Max77620Rtc BaselineMax77620Rtc
+#include "../baseline/rtc_r2p.hpp"
+#undef Max77620Rtc
+
+#include <cstdio>
+
+namespace Bench {
+
+    namespace {
+
+        template<typename Reboot>
+        void Row(char const *name, u64 const update_ns, Reboot &&reboot) {
+            Mock::Reset();
+            Mock::SetRtcUpdateLatency(update_ns);
+
+            auto const ok    = reboot();
+            auto const stats = Mock::RtcI2c();
+
+            std::printf("  %-28s %8.1f %6u %6llu %10.1f %10.1f %10.1f %4s\n", name, update_ns / 1e6,
+                        stats.transactions,
+                        static_cast<unsigned long long>(stats.bytes),
+                        stats.bus_ns / 1e3,
+                        Mock::SleptNs() / 1e3,
+                        Mock::ElapsedNs() / 1e3,
+                        ok ? "ok" : "fail");
+        }
+
+    }
+
+    void Rtc(Options const &) {
+        Max77620Rtc::rtc_reboot_reason_t rr = {};
+        rr.dec.reason = Max77620Rtc::REBOOT_REASON_SELF;
+
+        BaselineMax77620Rtc::rtc_reboot_reason_t baseline_rr = {};
+        baseline_rr.enc.val1 = rr.enc.val1;
+        baseline_rr.enc.val2 = rr.enc.val2;
+
+        std::printf("\nrtc: reboot reason through the simulated MAX77620 RTC, simulated time\n");
+        std::printf("  %-28s %8s %6s %6s %10s %10s %10s\n", "stage", "upd ms", "i2c", "bytes", "bus us", "slept us", "total us");
+
+        /* The datasheet gives no update time, so sweep it around the old fixed 16 ms sleep. */
+        for (u64 const update_ns : { 500'000, 2'000'000, 8'000'000 }) {
+            Row("before: byte by byte", update_ns, [&] { return BaselineMax77620Rtc::Reboot(&baseline_rr); });
+            Row("burst, polled", update_ns, [&] { return Max77620Rtc::Reboot(&rr); });
+        }
+    }
+
+}
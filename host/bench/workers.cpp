@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include "../baseline/tesla_renderer.hpp"
+#include "../harness/span_renderer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace Bench {
+
+    namespace {
+
+        namespace render = tsl::gfx::render;
+
+        constexpr s32 Width  = 448;
+        constexpr s32 Height = 720;
+        constexpr std::size_t Pixels = Width * ((Height + 127) & ~127);
+
+        /* numThreads with expanded memory. */
+        constexpr unsigned Threads = 4;
+
+        /* Calls per sample, so jobs of a few rows stay above the timer resolution. */
+        constexpr std::size_t Calls = 64;
+
+        constexpr u16 FillColor = 0x7A3C;
+
+        struct Job {
+            char const *name;
+            s32 y, rows;
+        };
+
+        template<typename Run>
+        void Row(Job const &job, char const *stage, unsigned const spawned, Options const &options, Run &&run) {
+            std::vector<u16> framebuffer(Pixels);
+            Harness::SpanRenderer span(framebuffer.data(), { 0, 0, Width, Height }, { 0, 0, Width, Height });
+
+            /* The band body of drawRoundedRectMultiThreaded, the rounded corners aside. */
+            auto band = [&span](s32 const startRow, s32 const endRow) {
+                auto const tables = render::makeBlendDstTables(FillColor);
+                for (s32 y = startRow; y < endRow; y++)
+                    span.drawSpanBlendDst(8, y, Width - 16, tables);
+            };
+
+            auto const sample = Harness::MeasureMedian(options.runs, [&] { std::fill(framebuffer.begin(), framebuffer.end(), 0); }, [&] {
+                for (std::size_t i = 0; i < Calls; i++)
+                    run(job, band);
+            });
+
+            std::printf("  %-12s %-16s %8u %10.2f   %08x\n", job.name, stage, spawned, sample.ns / 1000.0 / Calls,
+                        crc32Calculate(framebuffer.data(), framebuffer.size() * sizeof(u16)));
+        }
+
+    }
+
+    void Workers(Options const &options) {
+        std::printf("\nworkers: %u render threads on %u host cores, %zu calls per run, median of %zu runs\n",
+                    Threads, std::thread::hardware_concurrency(), Calls, options.runs);
+        std::printf("  %-12s %-16s %8s %10s   %8s\n", "job", "stage", "spawned", "us/call", "crc");
+
+        /* A rounded corner, a list item and the whole frame, handed out in bands of 4 rows. */
+        for (Job const job : { Job{ "4 rows", 200, 4 }, Job{ "70 rows", 97, 70 }, Job{ "720 rows", 0, Height } }) {
+            Row(job, "caller only", 0, options, [](Job const &job, auto &band) {
+                band(job.y, job.y + job.rows);
+            });
+
+            std::vector<std::thread> threads(Threads);
+            Row(job, "spawn per call", Threads, options, [&threads](Job const &job, auto &band) {
+                BaselineRenderer::runThreaded(threads, job.y, job.y + job.rows, band);
+            });
+
+            render::RenderWorkers workers(Threads);
+            workers.start();
+            Row(job, "worker pool", 0, options, [&workers](Job const &job, auto &band) {
+                workers.run(job.y, job.y + job.rows, 4, band);
+            });
+            workers.stop();
+        }
+    }
+
+}
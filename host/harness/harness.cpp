@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "harness.hpp"
+
+#include <mock.hpp>
+#include <payload.hpp>
+
+#include <sys/stat.h>
+#include <dirent.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+    std::atomic<u64> g_allocations;
+    std::atomic<u64> g_allocated_bytes;
+
+    struct {
+        std::atomic<u64> stat;
+        std::atomic<u64> open;
+        std::atomic<u64> read;
+        std::atomic<u64> write;
+        std::atomic<u64> seek;
+        std::atomic<u64> dir;
+    } g_fs;
+
+    void *Allocate(std::size_t const size) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+        if (auto const ptr = std::malloc(size ? size : 1))
+            return ptr;
+
+        std::abort();
+    }
+
+    void *AllocateAligned(std::size_t const size, std::align_val_t const alignment) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+        auto const align = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+        if (auto const ptr = std::aligned_alloc(align, (size + align - 1) / align * align))
+            return ptr;
+
+        std::abort();
+    }
+
+}
+
+/* Counts every heap allocation of the host binaries. */
+void *operator new(std::size_t const size) { return Allocate(size); }
+void *operator new[](std::size_t const size) { return Allocate(size); }
+void *operator new(std::size_t const size, std::nothrow_t const &) noexcept { return Allocate(size); }
+void *operator new[](std::size_t const size, std::nothrow_t const &) noexcept { return Allocate(size); }
+void *operator new(std::size_t const size, std::align_val_t const alignment) { return AllocateAligned(size, alignment); }
+void *operator new[](std::size_t const size, std::align_val_t const alignment) { return AllocateAligned(size, alignment); }
+void operator delete(void *const ptr) noexcept { std::free(ptr); }
+void operator delete[](void *const ptr) noexcept { std::free(ptr); }
+void operator delete(void *const ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *const ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *const ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *const ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *const ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *const ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+/* Linked with --wrap, see Makefile.host. */
+extern "C" {
+
+    int __real_stat(char const *path, struct stat *st);
+    FILE *__real_fopen(char const *path, char const *mode);
+    std::size_t __real_fread(void *ptr, std::size_t size, std::size_t count, FILE *file);
+    std::size_t __real_fwrite(void const *ptr, std::size_t size, std::size_t count, FILE *file);
+    int __real_fseek(FILE *file, long offset, int whence);
+    DIR *__real_opendir(char const *path);
+    struct dirent *__real_readdir(DIR *dirp);
+
+    int __wrap_stat(char const *path, struct stat *st) {
+        g_fs.stat.fetch_add(1, std::memory_order_relaxed);
+        return __real_stat(path, st);
+    }
+
+    FILE *__wrap_fopen(char const *path, char const *mode) {
+        g_fs.open.fetch_add(1, std::memory_order_relaxed);
+        return __real_fopen(path, mode);
+    }
+
+    std::size_t __wrap_fread(void *ptr, std::size_t size, std::size_t count, FILE *file) {
+        g_fs.read.fetch_add(1, std::memory_order_relaxed);
+        return __real_fread(ptr, size, count, file);
+    }
+
+    std::size_t __wrap_fwrite(void const *ptr, std::size_t size, std::size_t count, FILE *file) {
+        g_fs.write.fetch_add(1, std::memory_order_relaxed);
+        return __real_fwrite(ptr, size, count, file);
+    }
+
+    int __wrap_fseek(FILE *file, long offset, int whence) {
+        g_fs.seek.fetch_add(1, std::memory_order_relaxed);
+        return __real_fseek(file, offset, whence);
+    }
+
+    DIR *__wrap_opendir(char const *path) {
+        g_fs.dir.fetch_add(1, std::memory_order_relaxed);
+        return __real_opendir(path);
+    }
+
+    struct dirent *__wrap_readdir(DIR *dirp) {
+        g_fs.dir.fetch_add(1, std::memory_order_relaxed);
+        return __real_readdir(dirp);
+    }
+
+}
+
+namespace Harness {
+
+    Allocations AllocationCount() {
+        return { g_allocations.load(std::memory_order_relaxed), g_allocated_bytes.load(std::memory_order_relaxed) };
+    }
+
+    FsCalls FsCallCount() {
+        return {
+            g_fs.stat.load(std::memory_order_relaxed),
+            g_fs.open.load(std::memory_order_relaxed),
+            g_fs.read.load(std::memory_order_relaxed),
+            g_fs.write.load(std::memory_order_relaxed),
+            g_fs.seek.load(std::memory_order_relaxed),
+            g_fs.dir.load(std::memory_order_relaxed),
+        };
+    }
+
+    void PrintHeader(std::string_view const title) {
+        std::printf("\n%.*s\n", static_cast<int>(title.size()), title.data());
+        std::printf("  %-28s %10s %6s %6s %6s %6s %6s %8s %10s %8s\n", "stage", "us", "stat", "open", "read", "write", "dir", "allocs", "bytes", "entries");
+    }
+
+    void PrintSample(std::string_view const stage, Sample const &sample, std::size_t const entries) {
+        std::printf("  %-28.*s %10.1f %6llu %6llu %6llu %6llu %6llu %8llu %10llu %8zu\n", static_cast<int>(stage.size()), stage.data(),
+                    sample.ns / 1000.0,
+                    static_cast<unsigned long long>(sample.fs.stat),
+                    static_cast<unsigned long long>(sample.fs.open),
+                    static_cast<unsigned long long>(sample.fs.read + sample.fs.seek),
+                    static_cast<unsigned long long>(sample.fs.write),
+                    static_cast<unsigned long long>(sample.fs.dir),
+                    static_cast<unsigned long long>(sample.allocations.count),
+                    static_cast<unsigned long long>(sample.allocations.bytes),
+                    entries);
+    }
+
+    void PrintRate(Sample const &sample, std::size_t const items, std::string_view const unit) {
+        std::printf("  %-28s %10.2f M%.*s/s\n", "", sample.ns ? items * 1000.0 / sample.ns : 0.0, static_cast<int>(unit.size()), unit.data());
+    }
+
+    std::string MakeIni(std::string_view const prefix, std::size_t const sections, std::size_t const keys) {
+        std::string ini = "; generated by the host benchmark\n[config]\nautoboot=0\nautoboot_list=0\nbootwait=3\n\n";
+
+        char line[0x80];
+        for (std::size_t i = 0; i < sections; i++) {
+            std::snprintf(line, sizeof(line), "[%.*s %zu]\n", static_cast<int>(prefix.size()), prefix.data(), i + 1);
+            ini += line;
+
+            /* Mix the keys the menus look at with filler. */
+            ini += (i % 3 == 0) ? "emummcforce=1\n" : (i % 3 == 1) ? "emummc_force_disable=1\n" : "payload=bootloader/payloads/fusee.bin\n";
+            for (std::size_t key = 1; key < keys; key++) {
+                std::snprintf(line, sizeof(line), "kip1patch_%zu=nosigchk\n", key);
+                ini += line;
+            }
+
+            ini += "\n";
+        }
+
+        return ini;
+    }
+
+    std::string MakePayload(std::size_t const size, u32 const seed, bool const hekate) {
+        std::string payload(size, '\0');
+
+        u32 state = seed * 2654435761u + 1;
+        for (auto &byte : payload) {
+            state = state * 1103515245u + 12345u;
+            byte = static_cast<char>(state >> 24);
+        }
+
+        if (hekate && size >= Payload::MagicOffset + sizeof(Payload::Magic))
+            std::memcpy(payload.data() + Payload::MagicOffset, &Payload::Magic, sizeof(Payload::Magic));
+
+        return payload;
+    }
+
+    void GenerateTree(TreeShape const &shape) {
+        Mock::SdCard::WriteFile("sdmc:/bootloader/hekate_ipl.ini", MakeIni("boot", shape.boot_configs, shape.keys));
+        Mock::SdCard::MakeDirectory("sdmc:/bootloader/ini");
+        Mock::SdCard::MakeDirectory("sdmc:/bootloader/payloads");
+        Mock::SdCard::MakeDirectory("sdmc:/payloads");
+
+        char path[FS_MAX_PATH];
+        for (std::size_t i = 0; i < shape.ini_files; i++) {
+            std::snprintf(path, sizeof(path), "sdmc:/bootloader/ini/more_%04zu.ini", i);
+            Mock::SdCard::WriteFile(path, MakeIni("more", shape.ini_configs, shape.keys));
+        }
+
+        constexpr char const *PayloadDirs[] = { "sdmc:/", "sdmc:/bootloader/payloads/", "sdmc:/payloads/" };
+
+        u32 seed = 0;
+        for (auto const dir : PayloadDirs) {
+            for (std::size_t i = 0; i < shape.payloads; i++) {
+                std::snprintf(path, sizeof(path), "%spayload_%04zu.bin", dir, i);
+                Mock::SdCard::WriteFile(path, MakePayload(shape.payload_size, seed++, false));
+            }
+        }
+
+        Mock::SdCard::WriteFile("sdmc:/bootloader/update.bin", MakePayload(shape.payload_size, seed, true));
+    }
+
+}
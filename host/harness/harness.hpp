@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <switch.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Harness {
+
+    /* Heap allocations through operator new, counted by the replacement in harness.cpp. */
+    struct Allocations {
+        u64 count;
+        u64 bytes;
+    };
+
+    /**
+     * File system calls of the code under test, counted by wrapping the libc functions at
+     * link time. On the console each of them is at least one fsdev IPC.
+     */
+    struct FsCalls {
+        u64 stat;
+        u64 open;
+        u64 read;
+        u64 write;
+        u64 seek;
+        u64 dir;
+
+        u64 Total() const {
+            return stat + open + read + write + seek + dir;
+        }
+    };
+
+    Allocations AllocationCount();
+    FsCalls FsCallCount();
+
+    /* Latency, allocations and fs calls of one run. */
+    struct Sample {
+        u64 ns;
+        Allocations allocations;
+        FsCalls fs;
+    };
+
+    template<typename Function>
+    Sample Measure(Function &&function) {
+        auto const allocations = AllocationCount();
+        auto const fs          = FsCallCount();
+        auto const start       = armGetSystemTick();
+
+        function();
+
+        auto const ns = armTicksToNs(armGetSystemTick() - start);
+        auto const allocations_end = AllocationCount();
+        auto const fs_end          = FsCallCount();
+
+        return {
+            .ns = ns,
+            .allocations = { allocations_end.count - allocations.count, allocations_end.bytes - allocations.bytes },
+            .fs = { fs_end.stat - fs.stat, fs_end.open - fs.open, fs_end.read - fs.read, fs_end.write - fs.write, fs_end.seek - fs.seek, fs_end.dir - fs.dir },
+        };
+    }
+
+    /**
+     * Runs setup and function runs times and keeps the sample with the median latency.
+     * Counters of the code under test are deterministic, so any run reports them.
+     */
+    template<typename Setup, typename Function>
+    Sample MeasureMedian(std::size_t const runs, Setup &&setup, Function &&function) {
+        std::vector<Sample> samples;
+        samples.reserve(runs);
+
+        for (std::size_t i = 0; i < runs; i++) {
+            setup();
+            samples.push_back(Measure(function));
+        }
+
+        std::sort(samples.begin(), samples.end(), [](auto const &lhs, auto const &rhs) { return lhs.ns < rhs.ns; });
+
+        return samples[samples.size() / 2];
+    }
+
+    /* Prints the column header for PrintSample. */
+    void PrintHeader(std::string_view const title);
+
+    /* One row: latency, fs calls by kind, allocations and the resulting entry count. */
+    void PrintSample(std::string_view const stage, Sample const &sample, std::size_t const entries);
+
+    /* Throughput of the sample above it, in millions of unit per second. */
+    void PrintRate(Sample const &sample, std::size_t const items, std::string_view const unit);
+
+    /* Size of the synthetic SD card tree. */
+    struct TreeShape {
+        std::size_t boot_configs;    /* Sections in hekate_ipl.ini. */
+        std::size_t ini_files;       /* Files in bootloader/ini. */
+        std::size_t ini_configs;     /* Sections per ini file. */
+        std::size_t keys;            /* Keys per section. */
+        std::size_t payloads;        /* Payloads in each of the three payload folders. */
+        std::size_t payload_size;    /* Bytes per payload. */
+    };
+
+    /* hekate style ini with sections named <prefix> <index>. */
+    std::string MakeIni(std::string_view const prefix, std::size_t const sections, std::size_t const keys);
+
+    /* Deterministic payload bytes, with the hekate magic if requested. */
+    std::string MakePayload(std::size_t const size, u32 const seed, bool const hekate);
+
+    /* Writes hekate_ipl.ini, the ini folder, the payload folders and a hekate payload. */
+    void GenerateTree(TreeShape const &shape);
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <tesla_render.hpp>
+
+namespace Harness {
+
+    /*
+     * The span drawing members of tsl::gfx::Renderer on a plain framebuffer, built
+     * from the same tesla_render.hpp kernels and named like the Renderer ones: every
+     * run is clipped against the frame clip and the scissor once, then blended 8
+     * contiguous pixels at a time.
+     */
+    class SpanRenderer {
+        public:
+            struct Clip {
+                s32 x, y, w, h;
+            };
+
+            SpanRenderer(u16 *framebuffer, Clip const frame_clip, Clip const scissor)
+                : m_framebuffer(framebuffer), m_frameClip(frame_clip), m_scissor(scissor) { }
+
+            template<typename Func>
+            void forEachSpanGroup(s32 x, s32 const y, s32 const w, Func &&func) {
+                namespace render = tsl::gfx::render;
+                s32 x_end = x + w;
+
+                if (!render::clipSpan(x, x_end, y, m_frameClip.x, m_frameClip.y, m_frameClip.w, m_frameClip.h))
+                    return;
+                if (!render::clipSpan(x, x_end, y, m_scissor.x, m_scissor.y, m_scissor.w, m_scissor.h))
+                    return;
+
+                render::forEachSpanGroup(m_framebuffer, x, x_end, y, func);
+            }
+
+            void drawSpanBlendDst(s32 const x, s32 const y, s32 const w, tsl::gfx::render::BlendDstTables const &tables) {
+                this->forEachSpanGroup(x, y, w, [&tables](u16 *pixels, s32, s32 count) {
+                    tsl::gfx::render::blendDstPixels(pixels, count, tables);
+                });
+            }
+
+            void drawSpanBlendDst(s32 const x, s32 const y, s32 const w, u16 const color) {
+                if (w < tsl::gfx::render::BlendDstTablesMinWidth) {
+                    this->forEachSpanGroup(x, y, w, [color](u16 *pixels, s32, s32 count) {
+                        for (s32 i = 0; i < count; i++)
+                            pixels[i] = tsl::gfx::render::blendDst(pixels[i], color);
+                    });
+                } else {
+                    this->drawSpanBlendDst(x, y, w, tsl::gfx::render::makeBlendDstTables(color));
+                }
+            }
+
+            void drawRect(s32 const x, s32 const y, s32 const w, s32 const h, u16 const color) {
+                auto const tables = tsl::gfx::render::makeBlendDstTables(color);
+
+                for (s32 yi = y; yi < y + h; yi++)
+                    this->drawSpanBlendDst(x, yi, w, tables);
+            }
+
+            /* One bitmap row of a glyph, as drawString draws it. */
+            void drawGlyphRow(s32 const x, s32 const y, u8 const *coverage, s32 const w, u16 const color) {
+                this->forEachSpanGroup(x, y, w, [&](u16 *pixels, s32 px, s32 count) {
+                    tsl::gfx::render::blendCoveragePixels(pixels, coverage + (px - x), count, color);
+                });
+            }
+
+        private:
+            u16 *m_framebuffer;
+            Clip m_frameClip;
+            Clip m_scissor;
+    };
+
+}
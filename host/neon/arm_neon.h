@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * Stand in for <arm_neon.h> on hosts without NEON, so the NEON paths of the
+ * libtesla render kernels build and can be checked against the scalar ones.
+ * Every intrinsic is a plain lane loop with the ARM semantics, only the ones
+ * the kernels use are provided. On aarch64 hosts the real header is used.
+ *
+ * HOST_NEON_SCALAR leaves __ARM_NEON undefined, so the scalar kernels run. The
+ * benchmarks build that way, timing emulated lanes says nothing about the console.
+ */
+#if defined(__aarch64__)
+#include_next <arm_neon.h>
+#else
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+struct uint8x8_t   { std::uint8_t  lane[8];  };
+struct uint8x16_t  { std::uint8_t  lane[16]; };
+struct uint16x8_t  { std::uint16_t lane[8];  };
+struct uint8x16x2_t { uint8x16_t val[2]; };
+
+namespace Neon {
+
+    template<typename Vector, typename Op>
+    inline Vector Lanes(Op const op) {
+        Vector result;
+        for (std::size_t i = 0; i < std::size(result.lane); i++)
+            result.lane[i] = op(i);
+        return result;
+    }
+
+    template<int Shift> inline uint8x8_t ShiftRight(uint8x8_t const a)   { return Lanes<uint8x8_t>([&](std::size_t i) { return a.lane[i] >> Shift; }); }
+    template<int Shift> inline uint8x16_t ShiftRight(uint8x16_t const a) { return Lanes<uint8x16_t>([&](std::size_t i) { return a.lane[i] >> Shift; }); }
+    template<int Shift> inline uint16x8_t ShiftRight(uint16x8_t const a) { return Lanes<uint16x8_t>([&](std::size_t i) { return a.lane[i] >> Shift; }); }
+
+    template<int Shift> inline uint8x16_t ShiftLeft(uint8x16_t const a)  { return Lanes<uint8x16_t>([&](std::size_t i) { return static_cast<std::uint8_t>(a.lane[i] << Shift); }); }
+    template<int Shift> inline uint16x8_t ShiftLeft(uint16x8_t const a)  { return Lanes<uint16x8_t>([&](std::size_t i) { return static_cast<std::uint16_t>(a.lane[i] << Shift); }); }
+
+    template<int Shift> inline uint8x8_t ShiftRightNarrow(uint16x8_t const a) { return Lanes<uint8x8_t>([&](std::size_t i) { return static_cast<std::uint8_t>(a.lane[i] >> Shift); }); }
+
+}
+
+/* The shift amounts are immediates on ARM, so these are macros there as well. */
+#define vshr_n_u8(a, n)   Neon::ShiftRight<n>(a)
+#define vshrq_n_u8(a, n)  Neon::ShiftRight<n>(a)
+#define vshrq_n_u16(a, n) Neon::ShiftRight<n>(a)
+#define vshlq_n_u8(a, n)  Neon::ShiftLeft<n>(a)
+#define vshlq_n_u16(a, n) Neon::ShiftLeft<n>(a)
+#define vshrn_n_u16(a, n) Neon::ShiftRightNarrow<n>(a)
+
+inline uint8x8_t vld1_u8(std::uint8_t const *p)   { return Neon::Lanes<uint8x8_t>([&](std::size_t i) { return p[i]; }); }
+inline uint8x16_t vld1q_u8(std::uint8_t const *p) { return Neon::Lanes<uint8x16_t>([&](std::size_t i) { return p[i]; }); }
+inline uint16x8_t vld1q_u16(std::uint16_t const *p) { return Neon::Lanes<uint16x8_t>([&](std::size_t i) { return p[i]; }); }
+
+inline void vst1q_u8(std::uint8_t *p, uint8x16_t const a)   { std::memcpy(p, a.lane, sizeof(a.lane)); }
+inline void vst1q_u16(std::uint16_t *p, uint16x8_t const a) { std::memcpy(p, a.lane, sizeof(a.lane)); }
+
+inline uint8x8_t vdup_n_u8(std::uint8_t const x)    { return Neon::Lanes<uint8x8_t>([&](std::size_t) { return x; }); }
+inline uint8x16_t vdupq_n_u8(std::uint8_t const x)  { return Neon::Lanes<uint8x16_t>([&](std::size_t) { return x; }); }
+inline uint16x8_t vdupq_n_u16(std::uint16_t const x) { return Neon::Lanes<uint16x8_t>([&](std::size_t) { return x; }); }
+
+inline uint8x16_t vandq_u8(uint8x16_t const a, uint8x16_t const b)  { return Neon::Lanes<uint8x16_t>([&](std::size_t i) { return a.lane[i] & b.lane[i]; }); }
+inline uint8x16_t vorrq_u8(uint8x16_t const a, uint8x16_t const b)  { return Neon::Lanes<uint8x16_t>([&](std::size_t i) { return a.lane[i] | b.lane[i]; }); }
+inline uint16x8_t vandq_u16(uint16x8_t const a, uint16x8_t const b) { return Neon::Lanes<uint16x8_t>([&](std::size_t i) { return a.lane[i] & b.lane[i]; }); }
+inline uint16x8_t vorrq_u16(uint16x8_t const a, uint16x8_t const b) { return Neon::Lanes<uint16x8_t>([&](std::size_t i) { return a.lane[i] | b.lane[i]; }); }
+
+inline uint8x8_t vsub_u8(uint8x8_t const a, uint8x8_t const b)      { return Neon::Lanes<uint8x8_t>([&](std::size_t i) { return static_cast<std::uint8_t>(a.lane[i] - b.lane[i]); }); }
+inline uint16x8_t vaddq_u16(uint16x8_t const a, uint16x8_t const b) { return Neon::Lanes<uint16x8_t>([&](std::size_t i) { return static_cast<std::uint16_t>(a.lane[i] + b.lane[i]); }); }
+
+inline uint16x8_t vmull_u8(uint8x8_t const a, uint8x8_t const b) {
+    return Neon::Lanes<uint16x8_t>([&](std::size_t i) { return static_cast<std::uint16_t>(a.lane[i] * b.lane[i]); });
+}
+
+inline uint16x8_t vmlal_u8(uint16x8_t const acc, uint8x8_t const a, uint8x8_t const b) {
+    return Neon::Lanes<uint16x8_t>([&](std::size_t i) { return static_cast<std::uint16_t>(acc.lane[i] + a.lane[i] * b.lane[i]); });
+}
+
+inline uint8x8_t vmovn_u16(uint16x8_t const a) { return Neon::Lanes<uint8x8_t>([&](std::size_t i) { return static_cast<std::uint8_t>(a.lane[i]); }); }
+inline uint16x8_t vmovl_u8(uint8x8_t const a)  { return Neon::Lanes<uint16x8_t>([&](std::size_t i) { return a.lane[i]; }); }
+
+inline uint16x8_t vceqq_u16(uint16x8_t const a, uint16x8_t const b) {
+    return Neon::Lanes<uint16x8_t>([&](std::size_t i) { return a.lane[i] == b.lane[i] ? 0xFFFF : 0; });
+}
+
+inline uint16x8_t vbslq_u16(uint16x8_t const mask, uint16x8_t const a, uint16x8_t const b) {
+    return Neon::Lanes<uint16x8_t>([&](std::size_t i) { return (mask.lane[i] & a.lane[i]) | (~mask.lane[i] & b.lane[i]); });
+}
+
+/* Indices past the 32 table bytes give 0. */
+inline uint8x16_t vqtbl2q_u8(uint8x16x2_t const table, uint8x16_t const index) {
+    return Neon::Lanes<uint8x16_t>([&](std::size_t i) {
+        auto const at = index.lane[i];
+        return at < 32 ? table.val[at / 16].lane[at % 16] : 0;
+    });
+}
+
+#if !defined(HOST_NEON_SCALAR)
+#define __ARM_NEON 1
+#endif
+
+#endif
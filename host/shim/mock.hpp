@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <switch.h>
+
+#include <span>
+#include <string>
+#include <string_view>
+
+/*
+ * Control and inspection of the simulated console behind the host libnx shim.
+ */
+namespace Mock {
+
+    /* Console model reported by setsys, decides between the erista and mariko reboot paths. */
+    void SetProductModel(SetSysProductModel const model);
+
+    /* Time the code under test slept through svcSleepThread, which returns immediately on the host. */
+    u64 SleptNs();
+
+    /* Number of spsmShutdown calls, every successful reboot ends in one. */
+    u32 Shutdowns();
+
+    /* Whether Atmosphère's bpc:ams port exists, re-probe capabilities after changing it. */
+    void SetBpcAmsAvailable(bool const available);
+
+    /* Clears all counters and device state, keeps the product model and bpc:ams availability. */
+    void Reset();
+
+    /* Simulated time of the code under test: its sleeps plus the time its I2C transactions take. */
+    u64 ElapsedNs();
+
+    /**
+     * I2C traffic to the simulated MAX77620 RTC. Every transaction is one IPC to the i2c
+     * service plus the bytes on a 400 kHz bus, which is what bus_ns adds up.
+     */
+    struct I2cStats {
+        u32 transactions;
+        u64 bytes;
+        u64 bus_ns;
+    };
+
+    I2cStats RtcI2c();
+
+    /**
+     * The RTC register file. Bus accesses go to the buffered registers, UPDATE0 copies
+     * them from or to the clock after the update latency and flags that in UPDATE1.
+     * Only what reached the clock survives the reboot.
+     */
+    void SetRtcRegister(u8 const reg, u8 const value);
+    u8 RtcClockRegister(u8 const reg);
+    void SetRtcUpdateLatency(u64 const ns);
+
+    /**
+     * smcAmsIramCopy calls to the simulated secure monitor. Calls are invalid if they leave
+     * the payload window in IRAM or if their DRAM buffer crosses a page, which the secure
+     * monitor would not translate.
+     */
+    struct SmcStats {
+        u32 calls;
+        u64 bytes;
+        u32 invalid;
+    };
+
+    SmcStats Smc();
+
+    /* The payload window in IRAM as the next boot finds it, stale until written. */
+    std::span<u8 const> Iram();
+
+    /* Reboots to the IRAM payload requested through splSetConfig. */
+    u32 PayloadReboots();
+
+    /**
+     * IPC to the bpc:ams named port: connects (including failed ones), requests on an open
+     * session and session closes. SetRebootPayload records the size of its buffer.
+     */
+    struct IpcStats {
+        u32 connects;
+        u32 dispatches;
+        u32 closes;
+        u64 reboot_payload_size;
+
+        u32 Total() const {
+            return connects + dispatches + closes;
+        }
+    };
+
+    IpcStats BpcAms();
+
+    /**
+     * Temporary directory standing in for the SD card. The shim resolves sdmc:/ relative
+     * to the working directory, so this creates <tmp>/sdmc: and changes into <tmp> until
+     * it is destroyed.
+     */
+    class SdCard {
+      private:
+        std::string root;
+        std::string previous;
+
+      public:
+        SdCard();
+        ~SdCard();
+
+        SdCard(SdCard const &) = delete;
+        SdCard &operator=(SdCard const &) = delete;
+
+        /* Creates path and its parents, path starts with sdmc:/. */
+        static void MakeDirectory(std::string_view const path);
+        static bool WriteFile(std::string_view const path, std::string_view const data);
+        static void Remove(std::string_view const path);
+
+        /* Sets the modification time, so fingerprints change without waiting a second. */
+        static void Touch(std::string_view const path, s64 const mtime);
+    };
+
+}
@@ -0,0 +1,514 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "mock.hpp"
+
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace {
+
+    /* Same frequency as the console, so tick based code sees realistic values. */
+    constexpr u64 TickFrequency = 19'200'000;
+
+    /* Any failure code, the code under test only checks R_FAILED. */
+    constexpr Result ResultNotAvailable = 0xE401;
+
+    /* i2c service IPC round trip, then 9 clocks per byte including the ack at 400 kHz. */
+    constexpr u64 I2cTransactionNs = 20'000;
+    constexpr u64 I2cByteNs        = 22'500;
+
+    /* Registers of the MAX77620 RTC that the code under test uses. */
+    constexpr u8 RtcUpdate0     = 0x04;
+    constexpr u8 RtcUpdate1     = 0x05;
+    constexpr u8 RtcWriteUpdate = BIT(0);
+    constexpr u8 RtcReadUpdate  = BIT(4);
+    constexpr u8 RtcFirstTime   = 0x07;
+    constexpr u8 RtcLastAlarm   = 0x1B;
+
+    struct Rtc {
+        std::array<u8, 0x20> regs = {};
+        std::array<u8, 0x20> clock = {};
+        u8 address = 0;
+
+        /* Update requested through UPDATE0 that has not completed yet. */
+        u8 pending = 0;
+        u64 pending_since_ns = 0;
+        u64 update_ns = 2'000'000;
+
+        Mock::I2cStats stats = {};
+    };
+
+    /* smcAmsIramCopy and the IRAM it copies into, starting out with whatever ran before. */
+    constexpr u64 SmcAmsIramCopy  = 0xF0000201;
+    constexpr u64 IramPayloadBase = 0x40010000;
+    constexpr u64 SmcPageSize     = 0x1000;
+    constexpr u8 IramStale        = 0xA5;
+
+    /* splSetConfig item that makes exosphère reboot to the IRAM payload. */
+    constexpr u64 ExosphereRebootToPayload = 65001;
+
+    struct SecureMonitor {
+        std::array<u8, 0x24000> iram;
+        Mock::SmcStats stats = {};
+        u32 payload_reboots = 0;
+
+        SecureMonitor() {
+            iram.fill(IramStale);
+        }
+    };
+
+    /* The bpc:ams named port, handles are only handed out for it. */
+    constexpr Handle BpcAmsHandle = 0xB9C;
+    constexpr u32 BpcAmsSetRebootPayload = 65001;
+
+    struct NamedPort {
+        bool available = true;
+        u32 sessions = 0;
+        Mock::IpcStats stats = {};
+    };
+
+    struct State {
+        SetSysProductModel model = SetSysProductModel_Nx;
+        u64 slept_ns = 0;
+        u64 elapsed_ns = 0;
+        u32 shutdowns = 0;
+        Rtc rtc;
+        SecureMonitor secmon;
+        NamedPort bpc_ams;
+    } g_state;
+
+    constexpr auto MakeCrcTables() {
+        std::array<std::array<u32, 256>, 8> tables = {};
+
+        for (u32 i = 0; i < 256; i++) {
+            u32 crc = i;
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+
+            tables[0][i] = crc;
+        }
+
+        for (u32 i = 0; i < 256; i++) {
+            for (std::size_t t = 1; t < tables.size(); t++)
+                tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+        }
+
+        return tables;
+    }
+
+    constexpr auto CrcTables = MakeCrcTables();
+
+    /* Completes a pending update once its latency passed, in simulated time. */
+    void RtcAdvance(Rtc &rtc) {
+        if (rtc.pending == 0 || g_state.elapsed_ns < rtc.pending_since_ns + rtc.update_ns)
+            return;
+
+        for (u8 reg = RtcFirstTime; reg <= RtcLastAlarm; reg++) {
+            if (rtc.pending & RtcReadUpdate)
+                rtc.regs[reg] = rtc.clock[reg];
+            if (rtc.pending & RtcWriteUpdate)
+                rtc.clock[reg] = rtc.regs[reg];
+        }
+
+        /* The done flags sit at the same bits as the requests. */
+        rtc.regs[RtcUpdate1] |= rtc.pending;
+        rtc.pending = 0;
+    }
+
+    Result RtcTransaction(Rtc &rtc, std::size_t const size) {
+        rtc.stats.transactions++;
+        rtc.stats.bytes += size;
+
+        auto const ns = I2cTransactionNs + (1 + size) * I2cByteNs;
+        rtc.stats.bus_ns += ns;
+        g_state.elapsed_ns += ns;
+
+        RtcAdvance(rtc);
+
+        return 0;
+    }
+
+    /* The code under test uses sdmc:/ paths, which are relative to the working directory here. */
+    std::filesystem::path SdPath(std::string_view const path) {
+        return std::filesystem::path(path);
+    }
+
+}
+
+namespace Mock {
+
+    void SetProductModel(SetSysProductModel const model) {
+        g_state.model = model;
+    }
+
+    u64 SleptNs() {
+        return g_state.slept_ns;
+    }
+
+    u32 Shutdowns() {
+        return g_state.shutdowns;
+    }
+
+    void SetBpcAmsAvailable(bool const available) {
+        g_state.bpc_ams.available = available;
+    }
+
+    /* Sessions stay open, the code under test still holds them. */
+    void Reset() {
+        auto const bpc_ams = g_state.bpc_ams;
+        g_state = { .model = g_state.model, .bpc_ams = { .available = bpc_ams.available, .sessions = bpc_ams.sessions } };
+    }
+
+    u64 ElapsedNs() {
+        return g_state.elapsed_ns;
+    }
+
+    I2cStats RtcI2c() {
+        return g_state.rtc.stats;
+    }
+
+    void SetRtcRegister(u8 const reg, u8 const value) {
+        g_state.rtc.regs[reg % g_state.rtc.regs.size()]  = value;
+        g_state.rtc.clock[reg % g_state.rtc.clock.size()] = value;
+    }
+
+    u8 RtcClockRegister(u8 const reg) {
+        return g_state.rtc.clock[reg % g_state.rtc.clock.size()];
+    }
+
+    void SetRtcUpdateLatency(u64 const ns) {
+        g_state.rtc.update_ns = ns;
+    }
+
+    SmcStats Smc() {
+        return g_state.secmon.stats;
+    }
+
+    std::span<u8 const> Iram() {
+        return g_state.secmon.iram;
+    }
+
+    u32 PayloadReboots() {
+        return g_state.secmon.payload_reboots;
+    }
+
+    IpcStats BpcAms() {
+        return g_state.bpc_ams.stats;
+    }
+
+    SdCard::SdCard() {
+        char cwd[FS_MAX_PATH];
+        if (getcwd(cwd, sizeof(cwd)) != nullptr)
+            previous = cwd;
+
+        char root_template[] = "/tmp/qrb-sdmc-XXXXXX";
+        if (mkdtemp(root_template) == nullptr) {
+            std::perror("mkdtemp");
+            std::abort();
+        }
+
+        root = root_template;
+
+        if (chdir(root.c_str()) != 0 || mkdir("sdmc:", 0755) != 0) {
+            std::perror(root.c_str());
+            std::abort();
+        }
+    }
+
+    SdCard::~SdCard() {
+        if (!previous.empty() && chdir(previous.c_str()) != 0)
+            std::perror(previous.c_str());
+
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+    }
+
+    void SdCard::MakeDirectory(std::string_view const path) {
+        std::error_code ec;
+        std::filesystem::create_directories(SdPath(path), ec);
+    }
+
+    bool SdCard::WriteFile(std::string_view const path, std::string_view const data) {
+        auto const full = SdPath(path);
+
+        std::error_code ec;
+        std::filesystem::create_directories(full.parent_path(), ec);
+
+        auto const file = std::fopen(full.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        auto const ret = std::fwrite(data.data(), 1, data.size(), file);
+        std::fclose(file);
+
+        return ret == data.size();
+    }
+
+    void SdCard::Remove(std::string_view const path) {
+        std::error_code ec;
+        std::filesystem::remove(SdPath(path), ec);
+    }
+
+    void SdCard::Touch(std::string_view const path, s64 const mtime) {
+        struct timeval const times[2] = { { mtime, 0 }, { mtime, 0 } };
+        utimes(SdPath(path).c_str(), times);
+    }
+
+}
+
+extern "C" {
+
+    u64 armGetSystemTick(void) {
+        auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        return armNsToTicks(ns);
+    }
+
+    u64 armGetSystemTickFreq(void) {
+        return TickFrequency;
+    }
+
+    u64 armTicksToNs(u64 const tick) {
+        return static_cast<u64>((static_cast<unsigned __int128>(tick) * 1'000'000'000) / TickFrequency);
+    }
+
+    u64 armNsToTicks(u64 const ns) {
+        return static_cast<u64>((static_cast<unsigned __int128>(ns) * TickFrequency) / 1'000'000'000);
+    }
+
+    /* Same result as the libnx CRC32 instruction path, slicing by eight. */
+    u32 crc32Calculate(void const *const src, size_t size) {
+        auto data = static_cast<u8 const *>(src);
+        u32 crc = ~0u;
+
+        for (; size >= 8; size -= 8, data += 8) {
+            crc ^= data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<u32>(data[3]) << 24);
+            crc = CrcTables[7][crc & 0xFF] ^ CrcTables[6][(crc >> 8) & 0xFF] ^ CrcTables[5][(crc >> 16) & 0xFF] ^ CrcTables[4][crc >> 24] ^
+                  CrcTables[3][data[4]] ^ CrcTables[2][data[5]] ^ CrcTables[1][data[6]] ^ CrcTables[0][data[7]];
+        }
+
+        for (; size != 0; size--, data++)
+            crc = (crc >> 8) ^ CrcTables[0][(crc ^ *data) & 0xFF];
+
+        return ~crc;
+    }
+
+    void svcSleepThread(s64 const nano) {
+        if (nano > 0) {
+            g_state.slept_ns   += nano;
+            g_state.elapsed_ns += nano;
+        }
+    }
+
+    Result svcCallSecureMonitor(SecmonArgs *const args) {
+        auto &secmon = g_state.secmon;
+
+        if (args->X[0] != SmcAmsIramCopy)
+            return 0;
+
+        auto const dram   = args->X[1];
+        auto const iram   = args->X[2];
+        auto const size   = args->X[3];
+        auto const option = args->X[4];
+
+        secmon.stats.calls++;
+
+        auto const in_window   = iram >= IramPayloadBase && iram - IramPayloadBase + size <= secmon.iram.size();
+        auto const single_page = size <= SmcPageSize && (dram % SmcPageSize) + size <= SmcPageSize;
+        if (!in_window || !single_page) {
+            secmon.stats.invalid++;
+            args->X[0] = 1;
+            return 0;
+        }
+
+        auto const window = secmon.iram.data() + (iram - IramPayloadBase);
+        if (option == 1)
+            std::memcpy(window, reinterpret_cast<void const *>(dram), size);
+        else
+            std::memcpy(reinterpret_cast<void *>(dram), window, size);
+
+        secmon.stats.bytes += size;
+        args->X[0] = 0;
+
+        return 0;
+    }
+
+    Result svcConnectToNamedPort(Handle *const session, char const *const name) {
+        auto &port = g_state.bpc_ams;
+
+        if (std::strcmp(name, "bpc:ams") != 0)
+            return ResultNotAvailable;
+
+        port.stats.connects++;
+        if (!port.available)
+            return ResultNotAvailable;
+
+        port.sessions++;
+        *session = BpcAmsHandle;
+
+        return 0;
+    }
+
+    void serviceCreate(Service *const s, Handle const h) {
+        s->session = h;
+    }
+
+    void serviceClose(Service *const s) {
+        auto &port = g_state.bpc_ams;
+
+        if (s->session == BpcAmsHandle && port.sessions != 0) {
+            port.sessions--;
+            port.stats.closes++;
+        }
+
+        s->session = 0;
+    }
+
+    Result serviceDispatchImpl(Service *const s, u32 const request_id, SfDispatchParams const params) {
+        auto &port = g_state.bpc_ams;
+
+        if (s->session != BpcAmsHandle || port.sessions == 0)
+            return ResultNotAvailable;
+
+        port.stats.dispatches++;
+        if (request_id != BpcAmsSetRebootPayload)
+            return ResultNotAvailable;
+
+        port.stats.reboot_payload_size = params.buffers[0].size;
+
+        return 0;
+    }
+
+    Result i2cInitialize(void) {
+        return 0;
+    }
+
+    void i2cExit(void) { }
+
+    Result i2cOpenSession(I2cSession *const out, I2cDevice const dev) {
+        if (dev != I2cDevice_Max77620Rtc)
+            return ResultNotAvailable;
+
+        out->s.session = dev;
+        return 0;
+    }
+
+    void i2csessionClose(I2cSession *const s) {
+        s->s.session = 0;
+    }
+
+    /* The first byte selects the register, the following ones are written from there on. */
+    Result i2csessionSendAuto(I2cSession *const s, void const *const buf, size_t const size, I2cTransactionOption) {
+        if (s->s.session != I2cDevice_Max77620Rtc || size == 0)
+            return ResultNotAvailable;
+
+        auto &rtc = g_state.rtc;
+        auto const data = static_cast<u8 const *>(buf);
+
+        rtc.address = data[0];
+        for (size_t i = 1; i < size; i++, rtc.address++) {
+            auto const reg = rtc.address % rtc.regs.size();
+            rtc.regs[reg] = data[i];
+
+            if (reg == RtcUpdate0 && (data[i] & (RtcReadUpdate | RtcWriteUpdate))) {
+                rtc.pending = data[i] & (RtcReadUpdate | RtcWriteUpdate);
+                rtc.pending_since_ns = g_state.elapsed_ns;
+            }
+        }
+
+        return RtcTransaction(rtc, size);
+    }
+
+    /* Reads on from the selected register, reading UPDATE1 clears its done flags. */
+    Result i2csessionReceiveAuto(I2cSession *const s, void *const buf, size_t const size, I2cTransactionOption) {
+        if (s->s.session != I2cDevice_Max77620Rtc)
+            return ResultNotAvailable;
+
+        auto &rtc = g_state.rtc;
+        auto const result = RtcTransaction(rtc, size);
+
+        auto const data = static_cast<u8 *>(buf);
+        for (size_t i = 0; i < size; i++, rtc.address++) {
+            auto const reg = rtc.address % rtc.regs.size();
+            data[i] = rtc.regs[reg];
+
+            if (reg == RtcUpdate1)
+                rtc.regs[reg] = 0;
+        }
+
+        return result;
+    }
+
+    Result spsmInitialize(void) {
+        return 0;
+    }
+
+    void spsmExit(void) { }
+
+    Result spsmShutdown(bool) {
+        /* Whatever the RTC finished updating by now is what the next boot sees. */
+        RtcAdvance(g_state.rtc);
+        g_state.shutdowns++;
+        return 0;
+    }
+
+    Result splInitialize(void) {
+        return 0;
+    }
+
+    void splExit(void) { }
+
+    Result splGetConfig(SplConfigItem, u64 *) {
+        return ResultNotAvailable;
+    }
+
+    Result splSetConfig(SplConfigItem const item, u64 const value) {
+        if (item == ExosphereRebootToPayload && value == 2)
+            g_state.secmon.payload_reboots++;
+
+        return 0;
+    }
+
+    Result setsysInitialize(void) {
+        return 0;
+    }
+
+    void setsysExit(void) { }
+
+    Result setsysGetProductModel(SetSysProductModel *const model) {
+        *model = g_state.model;
+        return 0;
+    }
+
+    void consoleUpdate(PrintConsole *) { }
+
+    Event *appletGetMessageEvent(void) {
+        static Event event = {};
+        return &event;
+    }
+
+    Result eventWait(Event *, u64) {
+        return 0;
+    }
+
+}
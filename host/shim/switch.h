@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * Host stand-in for the parts of libnx used by common/ and the applet menu model.
+ * Only builds with Makefile.host. Services are backed by the mock devices in mock.hpp,
+ * sdmc:/ paths resolve relative to the working directory, see Mock::SdCard.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifndef __cplusplus
+#include <stdalign.h>
+#endif
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t   s8;
+typedef int16_t  s16;
+typedef int32_t  s32;
+typedef int64_t  s64;
+
+typedef u32 Result;
+typedef u32 Handle;
+
+#define BIT(n) (1U << (n))
+
+#define R_SUCCEEDED(res)   ((res) == 0)
+#define R_FAILED(res)      ((res) != 0)
+#define R_MODULE(res)      ((res) & 0x1FF)
+#define R_DESCRIPTION(res) (((res) >> 9) & 0x1FFF)
+
+#define FS_MAX_PATH 0x301
+
+/* Secure monitor */
+
+typedef struct {
+    u64 X[8];
+} SecmonArgs;
+
+/* IPC */
+
+typedef struct {
+    Handle session;
+} Service;
+
+typedef enum {
+    SfBufferAttr_In           = BIT(0),
+    SfBufferAttr_Out          = BIT(1),
+    SfBufferAttr_HipcMapAlias = BIT(2),
+} SfBufferAttr;
+
+typedef struct {
+    void const *ptr;
+    size_t size;
+} SfBuffer;
+
+typedef struct {
+    u32 buffer_attrs[8];
+    SfBuffer buffers[8];
+} SfDispatchParams;
+
+/* I2C */
+
+typedef struct {
+    Service s;
+} I2cSession;
+
+typedef enum {
+    I2cDevice_Max77620Rtc = 15,
+} I2cDevice;
+
+typedef enum {
+    I2cTransactionOption_Start = BIT(0),
+    I2cTransactionOption_Stop  = BIT(1),
+    I2cTransactionOption_All   = I2cTransactionOption_Start | I2cTransactionOption_Stop,
+} I2cTransactionOption;
+
+/* Settings */
+
+typedef enum {
+    SetSysProductModel_Invalid = 0,
+    SetSysProductModel_Nx      = 1,
+    SetSysProductModel_Copper  = 2,
+    SetSysProductModel_Iowa    = 3,
+    SetSysProductModel_Hoag    = 4,
+    SetSysProductModel_Calcio  = 5,
+    SetSysProductModel_Aula    = 6,
+} SetSysProductModel;
+
+typedef enum {
+    SplConfigItem_HardwareType = 4,
+} SplConfigItem;
+
+/* Console, input and applet, only what the menu model needs. */
+
+#define CONSOLE_COLOR_FAINT BIT(1)
+
+typedef struct {
+    int consoleWidth;
+    int consoleHeight;
+    int cursorX;
+    int cursorY;
+    int flags;
+} PrintConsole;
+
+typedef struct {
+    u64 buttons;
+} PadState;
+
+typedef struct {
+    bool signaled;
+} Event;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+u64 armGetSystemTick(void);
+u64 armGetSystemTickFreq(void);
+u64 armTicksToNs(u64 tick);
+u64 armNsToTicks(u64 ns);
+
+u32 crc32Calculate(void const *src, size_t size);
+
+void svcSleepThread(s64 nano);
+Result svcCallSecureMonitor(SecmonArgs *args);
+Result svcConnectToNamedPort(Handle *session, char const *name);
+
+void serviceCreate(Service *s, Handle h);
+void serviceClose(Service *s);
+Result serviceDispatchImpl(Service *s, u32 request_id, SfDispatchParams params);
+
+Result i2cInitialize(void);
+void i2cExit(void);
+Result i2cOpenSession(I2cSession *out, I2cDevice dev);
+void i2csessionClose(I2cSession *s);
+Result i2csessionSendAuto(I2cSession *s, void const *buf, size_t size, I2cTransactionOption option);
+Result i2csessionReceiveAuto(I2cSession *s, void *buf, size_t size, I2cTransactionOption option);
+
+Result spsmInitialize(void);
+void spsmExit(void);
+Result spsmShutdown(bool reboot);
+
+Result splInitialize(void);
+void splExit(void);
+Result splGetConfig(SplConfigItem config_item, u64 *out_config);
+Result splSetConfig(SplConfigItem config_item, u64 value);
+
+Result setsysInitialize(void);
+void setsysExit(void);
+Result setsysGetProductModel(SetSysProductModel *model);
+
+void consoleUpdate(PrintConsole *console);
+Event *appletGetMessageEvent(void);
+Result eventWait(Event *event, u64 timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define serviceDispatch(_s, _rid, ...) serviceDispatchImpl((_s), (_rid), (SfDispatchParams){ __VA_ARGS__ })
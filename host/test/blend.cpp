@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test.hpp"
+
+#include "../baseline/tesla_renderer.hpp"
+
+#include <tesla_render.hpp>
+
+#include <cstdio>
+#include <cstring>
+
+namespace Test {
+
+    namespace {
+
+        namespace render = tsl::gfx::render;
+
+        /* Renderer::blendDst before the kernels, on the Color bitfields, is the reference for all of them. */
+        u16 ReferenceBlendDst(u16 const dst, u16 const color) {
+            return BaselineRenderer::blendDst(dst, color);
+        }
+
+        /* Glyph drawing before the coverage kernel: the color, the pixel or a blendDst with the coverage as alpha. */
+        u16 ReferenceCoverage(u16 const dst, u8 const coverage, u16 const color) {
+            u8 const alpha = coverage >> 4;
+
+            if (alpha == 0xF)
+                return color;
+            if (alpha == 0x0)
+                return dst;
+
+            return ReferenceBlendDst(dst, (color & 0x0FFF) | (alpha << 12));
+        }
+
+        /* Counts differing pixels, printing the first one of every check. */
+        class Mismatches {
+            public:
+                explicit Mismatches(char const *name) : m_name(name) { }
+
+                void Compare(u16 const *pixels, u16 const *expected, s32 const count, u16 const color) {
+                    for (s32 i = 0; i < count; i++) {
+                        if (pixels[i] == expected[i])
+                            continue;
+
+                        if (m_count++ == 0)
+                            std::printf("  %s: color %04x gives %04x instead of %04x\n", m_name, color, pixels[i], expected[i]);
+                    }
+                }
+
+                std::size_t Count() const {
+                    return m_count;
+                }
+
+            private:
+                char const *m_name;
+                std::size_t m_count = 0;
+        };
+
+        /* Two groups of 8 pixels holding every nibble value in every channel, each channel in a different order. */
+        constexpr u16 MakeNibblePixel(unsigned const v) {
+            return (v & 0xF) | (((v + 5) & 0xF) << 4) | (((v + 9) & 0xF) << 8) | (((v + 13) & 0xF) << 12);
+        }
+
+        /* Colors covering every alpha with varying r, g and b, for the passes over all pixel values. */
+        constexpr u16 MakeSweepColor(unsigned const i) {
+            return ((i * 0x9E5) & 0x0FFF) | ((i & 0xF) << 12);
+        }
+
+        constexpr unsigned SweepColors = 32;
+
+        /* Runs kernel(pixels, color) over 8 pixels and compares them to reference, for the tables and for NEON. */
+        template<typename Kernel, typename Reference>
+        void CheckGroup(Mismatches &mismatches, u16 const (&input)[8], u16 const color, Kernel &&kernel, Reference &&reference) {
+            u16 pixels[8], expected[8];
+            std::memcpy(pixels, input, sizeof(pixels));
+
+            for (unsigned i = 0; i < 8; i++)
+                expected[i] = reference(i, input[i]);
+
+            kernel(pixels);
+            mismatches.Compare(pixels, expected, 8, color);
+        }
+
+        void BlendDstTables() {
+            Mismatches blend("blendDst"), scalar("blendDstPixelsScalar"), neon("blendDstPixelsNeon"), partial("blendDstPixels");
+
+            auto const check = [&](u16 const (&input)[8], u16 const color) {
+                auto const tables = render::makeBlendDstTables(color);
+                auto const reference = [color](unsigned, u16 const dst) { return ReferenceBlendDst(dst, color); };
+
+                CheckGroup(blend, input, color, [color](u16 *pixels) {
+                    for (unsigned i = 0; i < 8; i++)
+                        pixels[i] = render::blendDst(pixels[i], color);
+                }, reference);
+                CheckGroup(scalar, input, color, [&tables](u16 *pixels) { render::blendDstPixelsScalar(pixels, 8, tables); }, reference);
+                CheckGroup(neon, input, color, [&tables](u16 *pixels) { render::blendDstPixelsNeon(pixels, tables); }, reference);
+
+                /* Shorter groups at the ends of a run leave the pixels after them alone. */
+                for (s32 count = 1; count < 8; count++) {
+                    CheckGroup(partial, input, color, [&tables, count](u16 *pixels) { render::blendDstPixels(pixels, count, tables); },
+                               [color, count](unsigned const i, u16 const dst) { return static_cast<s32>(i) < count ? ReferenceBlendDst(dst, color) : dst; });
+                }
+            };
+
+            /* Every color against every nibble value in every channel. */
+            for (unsigned color = 0; color <= 0xFFFF; color++) {
+                for (unsigned group = 0; group < 2; group++) {
+                    u16 input[8];
+                    for (unsigned i = 0; i < 8; i++)
+                        input[i] = MakeNibblePixel(group * 8 + i);
+
+                    check(input, color);
+                }
+            }
+
+            /* Every pixel value against colors of every alpha. */
+            for (unsigned c = 0; c < SweepColors; c++) {
+                for (unsigned first = 0; first <= 0xFFFF; first += 8) {
+                    u16 input[8];
+                    for (unsigned i = 0; i < 8; i++)
+                        input[i] = first + i;
+
+                    check(input, MakeSweepColor(c));
+                }
+            }
+
+            CHECK(blend.Count() == 0);
+            CHECK(scalar.Count() == 0);
+            CHECK(neon.Count() == 0);
+            CHECK(partial.Count() == 0);
+        }
+
+        void BlendCoverage() {
+            Mismatches scalar("blendCoveragePixelsScalar"), neon("blendCoveragePixelsNeon"), partial("blendCoveragePixels");
+
+            /* Coverage nibble shift + i for lane i, the low bits are noise the kernels have to ignore. */
+            auto const check = [&](u16 const (&input)[8], u16 const color, unsigned const shift) {
+                u8 coverage[8];
+                for (unsigned i = 0; i < 8; i++)
+                    coverage[i] = (((shift + i) & 0xF) << 4) | ((i * 7 + shift) & 0xF);
+
+                auto const reference = [&coverage, color](unsigned const i, u16 const dst) { return ReferenceCoverage(dst, coverage[i], color); };
+
+                CheckGroup(scalar, input, color, [&](u16 *pixels) { render::blendCoveragePixelsScalar(pixels, coverage, 8, color); }, reference);
+                CheckGroup(neon, input, color, [&](u16 *pixels) { render::blendCoveragePixelsNeon(pixels, coverage, color); }, reference);
+
+                for (s32 count = 1; count < 8; count++) {
+                    CheckGroup(partial, input, color, [&](u16 *pixels) { render::blendCoveragePixels(pixels, coverage, count, color); },
+                               [&](unsigned const i, u16 const dst) { return static_cast<s32>(i) < count ? ReferenceCoverage(dst, coverage[i], color) : dst; });
+                }
+            };
+
+            /* Every color nibble against every coverage and pixel nibble; the color's own alpha only shows at full coverage. */
+            for (unsigned rgb = 0; rgb <= 0x0FFF; rgb++) {
+                u16 const color = rgb | (((rgb * 7) & 0xF) << 12);
+
+                for (unsigned shift = 0; shift < 16; shift++) {
+                    for (unsigned group = 0; group < 2; group++) {
+                        u16 input[8];
+                        for (unsigned i = 0; i < 8; i++)
+                            input[i] = MakeNibblePixel(group * 8 + i);
+
+                        check(input, color, shift);
+                    }
+                }
+            }
+
+            /* Every pixel value against every coverage. */
+            for (unsigned c = 0; c < SweepColors; c++) {
+                for (unsigned first = 0; first <= 0xFFFF; first += 8) {
+                    u16 input[8];
+                    for (unsigned i = 0; i < 8; i++)
+                        input[i] = first + i;
+
+                    check(input, MakeSweepColor(c), (first >> 3) + c);
+                }
+            }
+
+            CHECK(scalar.Count() == 0);
+            CHECK(neon.Count() == 0);
+            CHECK(partial.Count() == 0);
+        }
+
+    }
+
+    void Blend() {
+        BlendDstTables();
+        BlendCoverage();
+    }
+
+}
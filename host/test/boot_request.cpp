@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test.hpp"
+
+#include "../baseline/boot_request.hpp"
+
+#include <boot_request.hpp>
+#include <payload.hpp>
+
+#include <cstring>
+
+namespace Test {
+
+    namespace {
+
+        using Payload::BootRequest;
+
+        /* Payload bytes around the boot storage, which a reboot must leave alone. */
+        constexpr std::size_t ImageSize = Payload::BootStorageOffset + sizeof(Payload::BootStorage) + 0x10;
+
+        struct Image {
+            u8 bytes[ImageSize];
+
+            Image() {
+                for (std::size_t i = 0; i < ImageSize; i++)
+                    bytes[i] = static_cast<u8>(0xA5 ^ i);
+            }
+
+            bool operator==(Image const &other) const {
+                return std::memcmp(bytes, other.bytes, ImageSize) == 0;
+            }
+        };
+
+        /* Both the 6-bit registers and the decoded fields, bit for bit. */
+        bool SameRtc(Max77620Rtc::rtc_reboot_reason_t const &lhs, Max77620Rtc::rtc_reboot_reason_t const &rhs) {
+            return lhs.enc.val1 == rhs.enc.val1 && lhs.enc.val2 == rhs.enc.val2 &&
+                   lhs.dec.reason == rhs.dec.reason && lhs.dec.autoboot_idx == rhs.dec.autoboot_idx &&
+                   lhs.dec.autoboot_list == rhs.dec.autoboot_list && lhs.dec.ums_idx == rhs.dec.ums_idx;
+        }
+
+        /* The boot storage the way Reboot copies it into the payload. */
+        Image Store(BootRequest const &request) {
+            Image image;
+            auto const storage = request.ToBootStorage();
+            std::memcpy(image.bytes + Payload::BootStorageOffset, &storage, sizeof(storage));
+            return image;
+        }
+
+        template<typename Configure>
+        Image StoreBaseline(Configure &&configure) {
+            Image image;
+            configure(image.bytes);
+            return image;
+        }
+
+    }
+
+    void BootRequests() {
+        CHECK(SameRtc(BootRequest::Hekate().ToRtc(), BaselineBootRequest::HekateRtc()));
+        CHECK(Store(BootRequest::Hekate()) == StoreBaseline(BaselineBootRequest::HekateStorage));
+
+        CHECK(SameRtc(BootRequest::Menu().ToRtc(), BaselineBootRequest::MenuRtc()));
+        CHECK(Store(BootRequest::Menu()) == StoreBaseline(BaselineBootRequest::MenuStorage));
+
+        /* Every index a config list can hand out, the RTC keeps the low 4 bits like before. */
+        for (std::size_t index = 0; index <= 0xFF; index++) {
+            for (bool const list : { false, true }) {
+                auto const request = BootRequest::Config(index, list);
+
+                CHECK(SameRtc(request.ToRtc(), BaselineBootRequest::ConfigRtc(index, list)));
+                CHECK(Store(request) == StoreBaseline([&](u8 *payload) { BaselineBootRequest::ConfigStorage(payload, index, list); }));
+                CHECK(request.SupportsErista());
+            }
+        }
+
+        for (auto const target : { Payload::UmsTarget_Sd, Payload::UmsTarget_NandBoot0, Payload::UmsTarget_NandBoot1, Payload::UmsTarget_Nand,
+                                   Payload::UmsTarget_EmuMMCBoot0, Payload::UmsTarget_EmuMMCBoot1, Payload::UmsTarget_EmuMMC }) {
+            auto const request = BootRequest::Ums(target);
+
+            CHECK(SameRtc(request.ToRtc(), BaselineBootRequest::UmsRtc(target)));
+            CHECK(Store(request) == StoreBaseline([&](u8 *payload) { BaselineBootRequest::UmsStorage(payload, target); }));
+            CHECK(request.SupportsErista());
+        }
+
+        CHECK(SameRtc(BootRequest::Recovery().ToRtc(), BaselineBootRequest::ReasonRtc(Max77620Rtc::REBOOT_REASON_REC)));
+        CHECK(SameRtc(BootRequest::Panic().ToRtc(), BaselineBootRequest::ReasonRtc(Max77620Rtc::REBOOT_REASON_PANIC)));
+        CHECK(!BootRequest::Recovery().SupportsErista());
+        CHECK(!BootRequest::Panic().SupportsErista());
+    }
+
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test.hpp"
+
+#include <mock.hpp>
+#include <payload.hpp>
+#include <reboot_to_payload.h>
+#include <util.hpp>
+
+namespace Test {
+
+    namespace {
+
+        /* Erista with hekate on the SD card and bpc:ams present or not. */
+        void Boot(bool const bpc_ams) {
+            Payload::ClosePreloadSession();
+
+            Mock::SetProductModel(SetSysProductModel_Nx);
+            Mock::SetBpcAmsAvailable(bpc_ams);
+            Mock::Reset();
+
+            /* The probe leaves bpc:ams to the payload code, it never connects itself. */
+            util::ProbeCapabilities();
+            CHECK(Mock::BpcAms().Total() == 0);
+            CHECK(!util::GetCapabilities().bpc_ams);
+        }
+
+    }
+
+    void Bpc() {
+        Mock::SdCard const sd;
+        Mock::SdCard::WriteFile("sdmc:/bootloader/update.bin", Harness::MakePayload(0x20000, 0, true));
+
+        /* Preloaded: the session is open and checked, the reboot is the one request. */
+        Boot(true);
+        Payload::PreloadHekatePayload();
+        CHECK(Mock::BpcAms().connects == 1);
+        CHECK(util::GetCapabilities().bpc_ams);
+
+        auto const preloaded = Mock::BpcAms();
+        CHECK(Payload::RebootToHekate());
+
+        auto const reboot = Mock::BpcAms();
+        CHECK(reboot.Total() - preloaded.Total() == 1);
+        CHECK(reboot.dispatches == 1);
+        CHECK(reboot.reboot_payload_size == IRAM_PAYLOAD_MAX_SIZE);
+        CHECK(Mock::Shutdowns() == 1);
+        CHECK(Mock::Smc().calls == 0);
+
+        /* Without preload the reboot connects first. */
+        Boot(true);
+        CHECK(Payload::RebootToHekate());
+        CHECK(Mock::BpcAms().connects == 1);
+        CHECK(Mock::BpcAms().dispatches == 1);
+        CHECK(Mock::Shutdowns() == 1);
+
+        /* A port missing at probe and preload time, like with sm still holding the slot, */
+        /* is tried again on reboot instead of falling back to the secure monitor. */
+        Boot(false);
+        Payload::PreloadHekatePayload();
+        Mock::SetBpcAmsAvailable(true);
+        CHECK(Payload::RebootToHekate());
+        CHECK(Mock::BpcAms().connects == 2);
+        CHECK(Mock::BpcAms().dispatches == 1);
+        CHECK(Mock::Shutdowns() == 1);
+        CHECK(Mock::Smc().calls == 0);
+
+        /* Without bpc:ams at all the reboot connects once more, then uses the secure monitor. */
+        Boot(false);
+        Payload::PreloadHekatePayload();
+        CHECK(!util::GetCapabilities().bpc_ams);
+        CHECK(Payload::RebootToHekate());
+        CHECK(Mock::BpcAms().connects == 2);
+        CHECK(Mock::BpcAms().dispatches == 0);
+        CHECK(Mock::Smc().calls == IRAM_PAYLOAD_MAX_SIZE / 0x1000);
+        CHECK(Mock::PayloadReboots() == 1);
+
+        Boot(true);
+    }
+
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test.hpp"
+
+#include <mock.hpp>
+#include <payload.hpp>
+
+#include <bit>
+#include <cstdio>
+#include <string>
+
+namespace Test {
+
+    namespace {
+
+        constexpr char const *const HekateIniPath = "sdmc:/bootloader/hekate_ipl.ini";
+
+        template<typename Function>
+        u64 CountAllocations(Function &&function) {
+            return Harness::Measure(function).allocations.count;
+        }
+
+        /* Fills list with count payloads, reserving per entry like the scans do per file. */
+        void FillPayloads(Payload::PayloadConfigList &list, std::size_t const count) {
+            char name[0x20];
+            char path[0x40];
+
+            for (std::size_t i = 0; i < count; i++) {
+                auto const name_length = std::snprintf(name, sizeof(name), "payload_%zu", i);
+                auto const path_length = std::snprintf(path, sizeof(path), "sdmc:/payloads/payload_%zu.bin", i);
+
+                /* Both strings must fit before either is interned, growing would move the first. */
+                list.Reserve(list.size() + 1, list.StringSize() + name_length + path_length + 2);
+
+                auto const interned_name = list.Intern(name);
+                auto const interned_path = list.Intern(path);
+                list.Push({ .name = interned_name, .path = interned_path, .size = i, .crc = 0, .valid = true });
+            }
+        }
+
+        bool PayloadsIntact(Payload::PayloadConfigList const &list) {
+            char name[0x20];
+            char path[0x40];
+
+            std::size_t i = 0;
+            for (auto const &config : list) {
+                std::snprintf(name, sizeof(name), "payload_%zu", i);
+                std::snprintf(path, sizeof(path), "sdmc:/payloads/payload_%zu.bin", i);
+
+                /* Interned strings are null terminated for the C APIs. */
+                if (config.name != name || config.path != path || config.path.data()[config.path.size()] != '\0' || config.size != i)
+                    return false;
+
+                i++;
+            }
+
+            return i == list.size();
+        }
+
+        u64 HekateScanAllocations(std::size_t const sections) {
+            Mock::SdCard::WriteFile(HekateIniPath, Harness::MakeIni("boot", sections, 6));
+
+            std::size_t entries = 0;
+            auto const count = CountAllocations([&entries] { entries = Payload::LoadHekateConfigList().size(); });
+
+            CHECK(entries == sections);
+            return count;
+        }
+
+        u64 IniScanAllocations(std::size_t const files, std::size_t const configs) {
+            Mock::SdCard const sd;
+            Harness::GenerateTree({ .boot_configs = 1, .ini_files = files, .ini_configs = configs, .keys = 6, .payloads = 0, .payload_size = 0 });
+
+            std::size_t entries = 0;
+            auto const count = CountAllocations([&entries] { entries = Payload::LoadIniConfigList().size(); });
+
+            CHECK(entries == files * configs);
+            return count;
+        }
+
+    }
+
+    void ConfigList() {
+        /* Strings are moved along when the buffer grows, and small reserves stay amortized. */
+        {
+            Payload::PayloadConfigList list;
+
+            auto const allocations = CountAllocations([&list] { FillPayloads(list, 5000); });
+
+            CHECK(PayloadsIntact(list));
+            CHECK(allocations <= std::bit_width(list.size()) + std::bit_width(list.StringSize()));
+
+            auto const moved = std::move(list);
+            CHECK(PayloadsIntact(moved));
+        }
+
+        /* One reserve for the whole list: the entries and the string buffer, no matter how many. */
+        for (std::size_t const count : { 16, 16384 }) {
+            Payload::PayloadConfigList list;
+
+            auto const allocations = CountAllocations([&list, count] {
+                list.Reserve(count, count * 64);
+                FillPayloads(list, count);
+            });
+
+            CHECK(allocations == 2);
+            CHECK(PayloadsIntact(list));
+        }
+
+        /* A file scan costs the same whether it finds a few configs or thousands. */
+        {
+            Mock::SdCard const sd;
+            Mock::SdCard::MakeDirectory("sdmc:/bootloader");
+
+            auto const few  = HekateScanAllocations(32);
+            auto const many = HekateScanAllocations(3200);
+
+            CHECK(few == many);
+            CHECK(few <= 4);
+        }
+
+        /* The ini folder scan does not depend on configs per file either... */
+        CHECK(IniScanAllocations(64, 8) == IniScanAllocations(64, 80));
+
+        /* ...and its buffers grow geometrically with the file count, there is nothing per file. */
+        {
+            auto const few  = IniScanAllocations(16, 8);
+            auto const many = IniScanAllocations(1024, 8);
+
+            /* Listing names, offsets, config entries and string buffer double at most once per doubling. */
+            auto const doublings = std::bit_width(1024u / 16u) - 1;
+            CHECK(many <= few + 4 * doublings);
+        }
+    }
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test.hpp"
+
+#include <mock.hpp>
+#include <reboot_to_payload.h>
+
+#define g_reboot_payload baseline_reboot_payload
+#define smc_reboot_to_payload baseline_smc_reboot_to_payload
+#include "../baseline/reboot_to_payload.h"
+#undef g_reboot_payload
+#undef smc_reboot_to_payload
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace Test {
+
+    namespace {
+
+        constexpr std::size_t PageSize = 0x1000;
+        constexpr std::size_t Pages    = IRAM_PAYLOAD_MAX_SIZE / PageSize;
+
+        /* Fills buffer the way LoadPayload does: the payload, then 0xFF up to the end. */
+        void Stage(u8 (&buffer)[IRAM_PAYLOAD_MAX_SIZE], std::string const &payload) {
+            std::memset(buffer, 0xFF, sizeof(buffer));
+            std::memcpy(buffer, payload.data(), payload.size());
+        }
+
+        /* Hekate sees exactly the payload, nothing of what was in IRAM before. */
+        bool IramHolds(std::string const &payload) {
+            auto const iram = Mock::Iram();
+
+            return iram.size() == IRAM_PAYLOAD_MAX_SIZE &&
+                   std::memcmp(iram.data(), payload.data(), payload.size()) == 0 &&
+                   std::all_of(iram.begin() + payload.size(), iram.end(), [](u8 const byte) { return byte == 0xFF; });
+        }
+
+    }
+
+    void Iram() {
+        for (std::size_t const size : { std::size_t(0x13000), std::size_t(0x12345), std::size_t(IRAM_PAYLOAD_MAX_SIZE) }) {
+            auto const payload = Harness::MakePayload(size, static_cast<u32>(size), true);
+
+            /* Old upload: a clear pass and a write pass, each page bounced through a work page. */
+            Stage(baseline_reboot_payload, payload);
+            Mock::Reset();
+            baseline_smc_reboot_to_payload();
+
+            CHECK(IramHolds(payload));
+            CHECK(Mock::Smc().calls == 2 * Pages);
+            CHECK(Mock::Smc().bytes == 2 * IRAM_PAYLOAD_MAX_SIZE);
+            CHECK(Mock::Smc().invalid == 0);
+            CHECK(Mock::PayloadReboots() == 1);
+
+            /* Every page written once, straight from the payload buffer. */
+            Stage(g_reboot_payload, payload);
+            Mock::Reset();
+            smc_reboot_to_payload(size);
+
+            CHECK(IramHolds(payload));
+            CHECK(Mock::Smc().calls == Pages);
+            CHECK(Mock::Smc().bytes == IRAM_PAYLOAD_MAX_SIZE);
+            CHECK(Mock::Smc().invalid == 0);
+            CHECK(Mock::PayloadReboots() == 1);
+        }
+    }
+
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test.hpp"
+
+#include <util.hpp>
+
+#include <cstdio>
+#include <string_view>
+
+namespace {
+
+    struct Case {
+        std::string_view name;
+        void (*run)();
+    };
+
+    constexpr Case Cases[] = {
+        { "blend", Test::Blend },
+        { "boot_request", Test::BootRequests },
+        { "bpc", Test::Bpc },
+        { "config_list", Test::ConfigList },
+        { "iram", Test::Iram },
+        { "menu", Test::Menu },
+        { "rtc", Test::Rtc },
+        { "span", Test::Span },
+    };
+
+    unsigned g_failures = 0;
+
+}
+
+namespace Test {
+
+    void Fail(char const *file, int const line, char const *expression) {
+        std::printf("  %s:%d: CHECK(%s) failed\n", file, line, expression);
+        g_failures++;
+    }
+
+}
+
+/**
+ * Host tests, built with Makefile.host. Runs all cases or the ones named on the
+ * command line and exits with 1 if any check failed.
+ */
+int main(int const argc, char const *argv[]) {
+    util::ProbeCapabilities();
+
+    unsigned failed_cases = 0;
+
+    for (auto const &test : Cases) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++)
+            selected |= test.name == argv[i];
+
+        if (!selected)
+            continue;
+
+        auto const failures = g_failures;
+        test.run();
+
+        auto const ok = g_failures == failures;
+        std::printf("%-24.*s %s\n", static_cast<int>(test.name.size()), test.name.data(), ok ? "ok" : "FAILED");
+        failed_cases += !ok;
+    }
+
+    return failed_cases != 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test.hpp"
+
+#include <tui.hpp>
+
+#include <unistd.h>
+#include <bit>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Test {
+
+    namespace {
+
+        constexpr std::size_t SectionSize = 50;
+
+        /* Collects what the view prints, standing in for the console. */
+        class Capture {
+          private:
+            std::FILE *const file;
+            int const saved;
+
+          public:
+            Capture() : file(std::tmpfile()), saved(dup(STDOUT_FILENO)) {
+                std::fflush(stdout);
+                dup2(fileno(file), STDOUT_FILENO);
+            }
+
+            ~Capture() {
+                std::fflush(stdout);
+                dup2(saved, STDOUT_FILENO);
+                close(saved);
+                std::fclose(file);
+            }
+
+            /* Bytes printed since the last call. */
+            long Take() {
+                std::fflush(stdout);
+
+                auto const size = lseek(STDOUT_FILENO, 0, SEEK_END);
+                lseek(STDOUT_FILENO, 0, SEEK_SET);
+
+                return ftruncate(STDOUT_FILENO, 0) == 0 ? size : -1;
+            }
+        };
+
+        /* count entries in sections of SectionSize, each below its header. */
+        std::vector<std::string> MakeNames(std::size_t const count) {
+            std::vector<std::string> names;
+            names.reserve(count + count / SectionSize);
+
+            char name[0x20];
+            for (std::size_t i = 0; i < count; i++) {
+                if (i % SectionSize == 0) {
+                    std::snprintf(name, sizeof(name), "section %zu", i / SectionSize);
+                    names.emplace_back(name);
+                }
+
+                std::snprintf(name, sizeof(name), "entry %05zu", i);
+                names.emplace_back(name);
+            }
+
+            return names;
+        }
+
+        void Fill(Tui::Menu &menu, std::vector<std::string> const &names) {
+            menu.Reserve(names.size());
+
+            for (auto const &name : names) {
+                if (name.starts_with("section"))
+                    menu.AddHeader(name);
+                else
+                    menu.Add(name, nullptr, nullptr);
+            }
+        }
+
+        /* Item index of the n-th entry, every section adds its header in front. */
+        std::size_t ItemOf(std::size_t const n) {
+            return n + n / SectionSize + 1;
+        }
+
+        /* Bytes printed by paging down through the first screens, and that nothing allocated. */
+        long PageDownBytes(std::size_t const count) {
+            auto const names = MakeNames(count);
+            Tui::Menu menu;
+            Fill(menu, names);
+
+            PrintConsole console = { .consoleWidth = 80, .consoleHeight = 45, .cursorX = 0, .cursorY = 2, .flags = 0 };
+            Tui::View view(&console, console.cursorY);
+
+            Capture capture;
+            view.Draw(menu.Items(), menu.Index());
+            capture.Take();
+
+            long bytes = 0;
+            auto const allocations = Harness::Measure([&] {
+                for (int page = 0; page < 4; page++) {
+                    menu.Move(view.Rows());
+                    view.Draw(menu.Items(), menu.Index());
+                    view.Present();
+                }
+
+                bytes = capture.Take();
+            }).allocations.count;
+
+            CHECK(allocations == 0);
+            return bytes;
+        }
+
+    }
+
+    void Menu() {
+        constexpr std::size_t Count = 10000;
+
+        auto const names = MakeNames(Count);
+        Tui::Menu menu;
+
+        /* Five reserves for the item and filter tables, then only the lowered names grow. */
+        auto const build_allocations = Harness::Measure([&] { Fill(menu, names); }).allocations.count;
+        CHECK(build_allocations <= 5 + std::bit_width(names.size() * 16));
+
+        CHECK(menu.Items().size() == names.size());
+        CHECK(menu.Index() == ItemOf(0));
+
+        /* Rows skip the headers. */
+        menu.Move(1);
+        CHECK(menu.Index() == ItemOf(1));
+        menu.Move(SectionSize);
+        CHECK(menu.Index() == ItemOf(1 + SectionSize));
+        CHECK(menu.Selected()->text == "entry 00051");
+
+        /* Pages clamp to the first and the last entry. */
+        menu.Move(-static_cast<std::ptrdiff_t>(Count));
+        CHECK(menu.Index() == ItemOf(0));
+        menu.Move(Count * 2);
+        CHECK(menu.Index() == ItemOf(Count - 1));
+
+        /* A million moves through ten thousand entries cost nothing but the moves. */
+        auto const moves = Harness::Measure([&] {
+            for (int i = 0; i < 1'000'000; i++)
+                menu.Move((i & 1) ? 37 : -41);
+        });
+        CHECK(moves.allocations.count == 0);
+        CHECK(moves.ns < 100'000'000);
+
+        /* Search keeps the header above the match and restores everything when cleared. */
+        menu.Search("00042");
+        CHECK(menu.Items().size() == 3);
+        CHECK(menu.Selected() != nullptr && menu.Selected()->text == "entry 00042");
+        menu.Search("");
+        CHECK(menu.Items().size() == names.size());
+        CHECK(menu.Index() == ItemOf(0));
+
+        /* The view draws the window only, whatever the number of entries. */
+        auto const few  = PageDownBytes(1000);
+        auto const many = PageDownBytes(Count);
+        CHECK(few > 0 && few == many);
+    }
+
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test.hpp"
+
+#include <mock.hpp>
+#include <rtc_r2p.hpp>
+
+#define Max77620Rtc BaselineMax77620Rtc
+#include "../baseline/rtc_r2p.hpp"
+#undef Max77620Rtc
+
+namespace Test {
+
+    namespace {
+
+        constexpr u8 AlarmFirst    = 0x0E;
+        constexpr u8 AlarmLast     = 0x1B;
+        constexpr u8 Alarm1Weekday = 0x11;
+        constexpr u8 Alarm1Year    = 0x13;
+        constexpr u8 Alarm2Weekday = 0x18;
+        constexpr u8 Alarm2Year    = 0x1A;
+        constexpr u8 AlarmEnable   = BIT(7);
+        constexpr u8 ReasonMagic   = 0x77;
+
+        /* Both alarms armed, like Horizon leaves them. */
+        void ArmAlarms() {
+            Mock::Reset();
+
+            for (u8 reg = AlarmFirst; reg <= AlarmLast; reg++)
+                Mock::SetRtcRegister(reg, AlarmEnable | reg);
+        }
+
+        /* What hekate finds in the RTC after the reboot. */
+        bool ReasonStored(u16 const val1, u16 const val2) {
+            for (u8 reg = AlarmFirst; reg <= AlarmLast; reg++) {
+                u8 expected = reg;
+
+                if (reg == Alarm1Year)
+                    expected = val1;
+                else if (reg == Alarm2Year)
+                    expected = val2;
+                else if (reg == Alarm1Weekday || reg == Alarm2Weekday)
+                    expected = ReasonMagic;
+
+                if (Mock::RtcClockRegister(reg) != expected)
+                    return false;
+            }
+
+            return true;
+        }
+
+    }
+
+    void Rtc() {
+        Max77620Rtc::rtc_reboot_reason_t rr = {};
+        rr.dec.reason        = Max77620Rtc::REBOOT_REASON_SELF;
+        rr.dec.autoboot_idx  = 3;
+        rr.dec.autoboot_list = 1;
+
+        BaselineMax77620Rtc::rtc_reboot_reason_t baseline_rr = {};
+        baseline_rr.enc.val1 = rr.enc.val1;
+        baseline_rr.enc.val2 = rr.enc.val2;
+
+        /* Old sequence: every alarm register read and written on its own, 16 ms sleeps. */
+        ArmAlarms();
+        CHECK(BaselineMax77620Rtc::Reboot(&baseline_rr));
+        CHECK(ReasonStored(rr.enc.val1, rr.enc.val2));
+        CHECK(Mock::Shutdowns() == 1);
+
+        auto const baseline = Mock::RtcI2c();
+        auto const baseline_ns = Mock::ElapsedNs();
+        CHECK(baseline.transactions == 49);
+
+        /* Same registers written, through one burst read and write and polled updates. */
+        ArmAlarms();
+        CHECK(Max77620Rtc::Reboot(&rr));
+        CHECK(ReasonStored(rr.enc.val1, rr.enc.val2));
+        CHECK(Mock::Shutdowns() == 1);
+
+        /* Each update: clear UPDATE1 (2), request (1), two polls for a 2 ms update (4). */
+        /* In between the alarm block is read (2) and written (1). */
+        auto const batched = Mock::RtcI2c();
+        CHECK(batched.transactions == 2 * 7 + 3);
+        CHECK(Mock::ElapsedNs() * 4 < baseline_ns);
+
+        /* Updates slower than the old fixed sleep still finish before the shutdown. */
+        ArmAlarms();
+        Mock::SetRtcUpdateLatency(12'000'000);
+        CHECK(Max77620Rtc::Reboot(&rr));
+        CHECK(ReasonStored(rr.enc.val1, rr.enc.val2));
+    }
+
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test.hpp"
+
+#include "../baseline/tesla_renderer.hpp"
+#include "../harness/span_renderer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace Test {
+
+    namespace {
+
+        /* The overlay framebuffer, allocated with the height rounded up to whole blocks. */
+        constexpr s32 Width  = 448;
+        constexpr s32 Height = 720;
+        constexpr std::size_t Pixels = Width * ((Height + 127) & ~127);
+
+        using SpanRenderer = Harness::SpanRenderer;
+
+        struct Clips {
+            char const *name;
+            SpanRenderer::Clip frame;
+            SpanRenderer::Clip scissor;
+        };
+
+        constexpr Clips ClipCases[] = {
+            { "full frame", { 0, 0, Width, Height }, { 0, 0, Width, Height } },
+            { "damaged area", { 13, 5, 301, 600 }, { 0, 0, Width, Height } },
+            { "scissored", { 0, 0, Width, Height }, { 35, 100, 250, 300 } },
+            { "both", { 9, 64, 400, 500 }, { 3, 50, 261, 400 } },
+        };
+
+        /* Block and group edges, the frame edges and a few rows past them. */
+        constexpr s32 Rows[]    = { -1, 0, 1, 2, 7, 8, 15, 16, 17, 63, 100, 127, 128, 129, 255, 256, 383, 500, 639, 640, 719, 720 };
+        constexpr s32 Columns[] = { -20, -1, 0, 1, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, 255, 256, 439, 440, 447, 448 };
+        constexpr s32 Widths[]  = { 0, 1, 2, 7, 8, 9, 15, 16, 17, 23, 31, 33, 64, 200, 447, 448, 500 };
+
+        constexpr u16 Colors[] = { 0x0000, 0xF000, 0x7A3C, 0x1FFF, 0xEDCB, 0xFFFF };
+
+        void Fill(std::vector<u16> &framebuffer, u32 seed) {
+            for (auto &pixel : framebuffer) {
+                seed = seed * 1664525 + 1013904223;
+                pixel = seed >> 16;
+            }
+        }
+
+        /* Compares the whole framebuffers, so stray writes outside a run are caught as well. */
+        bool Same(std::vector<u16> const &spans, std::vector<u16> const &pixels, char const *what, Clips const &clips, u16 const color, s32 const y) {
+            if (std::memcmp(spans.data(), pixels.data(), Pixels * sizeof(u16)) == 0)
+                return true;
+
+            std::printf("  %s, %s, color %04x, row %d differs\n", what, clips.name, color, y);
+            return false;
+        }
+
+    }
+
+    void Span() {
+        std::vector<u16> spans(Pixels), pixels(Pixels);
+        std::vector<u8> coverage(Width + 64);
+
+        for (auto const &clips : ClipCases) {
+            for (u16 const color : Colors) {
+                SpanRenderer span(spans.data(), clips.frame, clips.scissor);
+                BaselineRenderer baseline(pixels.data(), { clips.frame.x, clips.frame.y, clips.frame.w, clips.frame.h },
+                                          { clips.scissor.x, clips.scissor.y, clips.scissor.w, clips.scissor.h }, Width, Height);
+
+                Fill(spans, color);
+                Fill(pixels, color);
+
+                /* Every run once through drawSpanBlendDst, short ones per pixel and longer ones through the tables. */
+                bool same = true;
+                for (s32 const y : Rows) {
+                    for (s32 const x : Columns) {
+                        for (s32 const w : Widths) {
+                            span.drawSpanBlendDst(x, y, w, color);
+                            baseline.drawSpanBlendDst(x, y, w, color);
+                        }
+                    }
+
+                    same = same && Same(spans, pixels, "drawSpanBlendDst", clips, color, y);
+                }
+                CHECK(same);
+
+                /* Glyph rows with every coverage nibble, starting at every column of a group. */
+                same = true;
+                for (std::size_t i = 0; i < coverage.size(); i++)
+                    coverage[i] = static_cast<u8>(i * 37 + color);
+
+                for (s32 const y : Rows) {
+                    for (s32 const x : Columns) {
+                        for (s32 const w : Widths) {
+                            auto const w_clamped = std::min<s32>(w, coverage.size());
+                            span.drawGlyphRow(x, y, coverage.data(), w_clamped, color);
+                            baseline.drawGlyphRow(x, y, coverage.data(), w_clamped, color);
+                        }
+                    }
+
+                    same = same && Same(spans, pixels, "glyph row", clips, color, y);
+                }
+                CHECK(same);
+
+                /* Rectangles, the tables built once for all rows. */
+                span.drawRect(-3, -5, 200, 140, color);
+                baseline.drawRect(-3, -5, 200, 140, color);
+                span.drawRect(77, 121, 301, 555, color);
+                baseline.drawRect(77, 121, 301, 555, color);
+                CHECK(Same(spans, pixels, "drawRect", clips, color, 0));
+            }
+        }
+    }
+
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020-2023 Studious Pancake
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "../harness/harness.hpp"
+
+/* Records a failed check and keeps going, so one run reports every failure. */
+#define CHECK(expression) ((expression) ? (void)0 : Test::Fail(__FILE__, __LINE__, #expression))
+
+namespace Test {
+
+    void Fail(char const *file, int const line, char const *expression);
+
+    /* libtesla blend kernels, scalar and NEON, against the per-pixel blendDst over every nibble and alpha. */
+    void Blend();
+
+    /* BootRequest encodings against the boot storage and RTC writes they replaced. */
+    void BootRequests();
+
+    /* IPC to bpc:ams on the reboot path, with and without preload. */
+    void Bpc();
+
+    /* Allocations of the config lists and the scans filling them. */
+    void ConfigList();
+
+    /* Applet menu navigation and drawing with thousands of entries. */
+    void Menu();
+
+    /* Payload upload to IRAM through the simulated secure monitor. */
+    void Iram();
+
+    /* Reboot reason written to the simulated MAX77620 RTC. */
+    void Rtc();
+
+    /* libtesla span drawing against the per pixel drawing, compared byte for byte. */
+    void Span();
+
+}
@@ -59,6 +59,7 @@
 #include <chrono>
 #include <list>
 #include <stack>
+#include <array> // CUSTOM MODIFICATION
 #include <map>
 
 
@@ -1116,7 +1117,8 @@ inline float calculateAmplitude(float x, float peakDurationFactor = 0.25f) {
 
 
 static std::atomic<bool> refreshWallpaper(false);
-static std::vector<u8> wallpaperData;
+static std::vector<u16> wallpaperData; // Wallpaper blended over the background color, in framebuffer layout // CUSTOM MODIFICATION
+static u16 wallpaperBackground = 0;    // Background color the wallpaper cache was blended with // CUSTOM MODIFICATION
 static std::atomic<bool> inPlot(false);
 
 std::mutex wallpaperMutex;
@@ -1124,47 +1126,6 @@ std::condition_variable cv;
 
 
 
-// Function to load the RGBA file into memory and modify wallpaperData directly
-void loadWallpaperFile(const std::string& filePath, s32 width = 448, s32 height = 720) {
-    // Calculate the size of the bitmap in bytes
-    size_t dataSize = width * height * 4; // 4 bytes per pixel (RGBA8888)
-    
-    // Resize the wallpaperData vector to the required size
-    wallpaperData.resize(dataSize);
-    
-    if (!isFileOrDirectory(filePath)) {
-        wallpaperData.clear(); // Clear wallpaperData if loading failed
-        return;
-    }
-
-    // Open the file in binary mode
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file) {
-        //std::cerr << "Failed to open file: " << filePath << std::endl;
-        wallpaperData.clear(); // Clear wallpaperData if loading failed
-        return;
-    }
-    
-    // Read the file content into the wallpaperData buffer
-    file.read(reinterpret_cast<char*>(wallpaperData.data()), dataSize);
-    if (!file) {
-        //std::cerr << "Failed to read file: " << filePath << std::endl;
-        wallpaperData.clear(); // Clear wallpaperData if reading failed
-        return;
-    }
-    
-    // Preprocess the bitmap data by shifting the color values
-    for (size_t i = 0; i < dataSize; i += 4) {
-        // Shift the color values to reduce precision (if needed)
-        wallpaperData[i] >>= 4;   // Red
-        wallpaperData[i + 1] >>= 4; // Green
-        wallpaperData[i + 2] >>= 4; // Blue
-        wallpaperData[i + 3] >>= 4; // Alpha
-    }
-}
-
-
-
 //static uint8x16x4_t pixelData;
 
 // Global variables for FPS calculation
@@ -1608,16 +1569,16 @@ void reinitializeVersionLabels() {
 
 // Number of renderer threads to use
 const unsigned numThreads = expandedMemory ? 4 : 0;
-std::vector<std::thread> threads(numThreads);
-s32 bmpChunkSize = (720 + numThreads - 1) / numThreads;
-std::atomic<s32> currentRow;
 
-#include <barrier>
+// CUSTOM MODIFICATION START
+// Pixel kernels, damage tracking and the renderer worker threads, standalone so the host can test them
+#include "tesla_render.hpp"
 
-// Assuming numThreads is the number of threads you have
-std::barrier inPlotBarrier(numThreads, [](){
-    inPlot.store(false, std::memory_order_release);
-});
+/**
+ * @brief Persistent renderer worker threads, started once by Renderer::init
+ */
+static tsl::gfx::render::RenderWorkers renderWorkers(numThreads);
+// CUSTOM MODIFICATION END
 
 
 
@@ -2400,9 +2361,7 @@ namespace tsl {
         //Color src(0);
         //Color end(0);
 
-        struct ScissoringConfig {
-            s32 x, y, w, h;
-        };
+        using ScissoringConfig = render::Rect; // CUSTOM MODIFICATION
         
         /**
          * @brief Manages the Tesla layer and draws raw data to the screen
@@ -2444,6 +2403,62 @@ namespace tsl {
                 this->m_scissoringStack.pop();
             }
             
+            // CUSTOM MODIFICATION START
+            // The tracking lives in tesla_render.hpp, so the host bench runs the same damage path
+            using FrameStats = render::FrameDamage::Stats;
+            
+            /**
+             * @brief Marks an area of the screen to be redrawn, elements call this when their content changes outside of input handling
+             *
+             * @param x X pos
+             * @param y Y pos
+             * @param w Width
+             * @param h Height
+             */
+            static void markDirty(const s32 x, const s32 y, const s32 w, const s32 h) {
+                Renderer::s_frameDamage.mark({ x, y, w, h });
+            }
+            
+            /**
+             * @brief Marks the whole screen to be redrawn
+             */
+            static void markAllDirty() {
+                markDirty(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
+            }
+            
+            /**
+             * @brief Checks if an area overlaps the part of the current frame that gets redrawn
+             *
+             * @param x X pos
+             * @param y Y pos
+             * @param w Width
+             * @param h Height
+             * @return Whether drawing inside the area has any effect
+             */
+            inline bool isDirty(const s32 x, const s32 y, const s32 w, const s32 h) {
+                return x < this->m_frameClip.x + this->m_frameClip.w && x + w > this->m_frameClip.x &&
+                       y < this->m_frameClip.y + this->m_frameClip.h && y + h > this->m_frameClip.y;
+            }
+            
+            /**
+             * @brief Checks if the whole current frame gets redrawn
+             *
+             * @return Whether the frame clip covers the framebuffer
+             */
+            inline bool isFullFrame() {
+                return this->m_frameClip.w == cfg::FramebufferWidth && this->m_frameClip.h == cfg::FramebufferHeight;
+            }
+            
+            /**
+             * @brief Gets the frame counters of the damage tracking
+             *
+             * @return Frame counters
+             */
+            static const FrameStats& getFrameStats() {
+                return Renderer::s_frameDamage.stats();
+            }
+            // CUSTOM MODIFICATION END
+            
             
             // Drawing functions
             
@@ -2474,8 +2489,38 @@ namespace tsl {
              * @param alpha Opacity
              * @return Blended color
              */
-            inline u8 blendColor(const u8 src, const u8 dst, const u8 alpha) {
-                return (dst * alpha + src * (0x0F - alpha)) >> 4;
+            static inline u8 blendColor(const u8 src, const u8 dst, const u8 alpha) { // CUSTOM MODIFICATION
+                return render::blendColor(src, dst, alpha);
+            }
+            
+            /**
+             * @brief Blends a color over a framebuffer pixel, keeping the pixel's alpha
+             *
+             * @param dst Framebuffer pixel
+             * @param color Color
+             * @return Blended pixel
+             */
+            inline u16 blendSrc(const u16 dst, const Color& color) {
+                Color src(dst);
+                
+                Color end(0);
+                end.r = blendColor(src.r, color.r, color.a);
+                end.g = blendColor(src.g, color.g, color.a);
+                end.b = blendColor(src.b, color.b, color.a);
+                end.a = src.a;
+                
+                return end.rgba;
+            }
+            
+            /**
+             * @brief Blends a color over a framebuffer pixel, accumulating alpha
+             *
+             * @param dst Framebuffer pixel
+             * @param color Color
+             * @return Blended pixel
+             */
+            inline u16 blendDst(const u16 dst, const Color& color) {
+                return render::blendDst(dst, color.rgba); // CUSTOM MODIFICATION
             }
             
             /**
@@ -2486,24 +2531,12 @@ namespace tsl {
              * @param color Color
              */
             inline void setPixelBlendSrc(const s32 x, const s32 y, const Color& color) {
-                //if (x < 0 || y < 0 || x >= cfg::FramebufferWidth || y >= cfg::FramebufferHeight)
-                //    return;
-                
                 u32 offset = this->getPixelOffset(x, y);
                 if (offset == UINT32_MAX)
                     return;
                 
                 u16* framebuffer = static_cast<u16*>(this->getCurrentFramebuffer());
-                //src=framebuffer[offset];
-                Color src(framebuffer[offset]);
-                
-                Color end(0);
-                end.r = blendColor(src.r, color.r, color.a);
-                end.g = blendColor(src.g, color.g, color.a);
-                end.b = blendColor(src.b, color.b, color.a);
-                end.a = src.a;
-            
-                this->setPixel(x, y, end, offset);
+                this->setPixel(x, y, this->blendSrc(framebuffer[offset], color), offset);
             }
             
             /**
@@ -2514,25 +2547,110 @@ namespace tsl {
              * @param color Color
              */
             inline void setPixelBlendDst(const s32 x, const s32 y, const Color& color) {
-                //if (x < 0 || y < 0 || x >= cfg::FramebufferWidth || y >= cfg::FramebufferHeight)
-                //    return;
-                
                 u32 offset = this->getPixelOffset(x, y);
                 if (offset == UINT32_MAX)
                     return;
                 
                 u16* framebuffer = static_cast<u16*>(this->getCurrentFramebuffer());
-                //src=framebuffer[offset];
-                Color src(framebuffer[offset]);
+                this->setPixel(x, y, this->blendDst(framebuffer[offset], color), offset);
+            }
+            
+            // CUSTOM MODIFICATION START
+            // Kernels live in tesla_render.hpp, so the host can check them against blendDst
+            using BlendDstTables = render::BlendDstTables;
+            
+            inline BlendDstTables makeBlendDstTables(const Color& color) {
+                return render::makeBlendDstTables(color.rgba);
+            }
+            
+            static inline void blendDstPixels(u16* pixels, const s32 count, const BlendDstTables& tables) {
+                render::blendDstPixels(pixels, count, tables);
+            }
+            
+            inline void blendCoveragePixels(u16* pixels, const u8* coverage, const s32 count, const Color& color) {
+                render::blendCoveragePixels(pixels, coverage, count, color.rgba);
+            }
+            
+            /**
+             * @brief Calls func(pixels, x, count) for every contiguous group of a horizontal run
+             *
+             * The run is clipped against the framebuffer and the active scissor once, then
+             * walked through the block linear layout one group of up to 8 contiguous pixels
+             * at a time instead of swizzling and clipping every pixel on its own. Aligned
+             * groups inside the run hold exactly 8 pixels.
+             *
+             * @param x X start pos
+             * @param y Y pos
+             * @param w Width of the run
+             * @param func Group function, receives the first framebuffer pixel, its x pos and the pixel count
+             */
+            template<typename Func>
+            inline void forEachSpanGroup(s32 x, const s32 y, const s32 w, Func&& func) {
+                s32 x_end = x + w;
                 
-                Color end(0);
-                end.r = blendColor(src.r, color.r, color.a);
-                end.g = blendColor(src.g, color.g, color.a);
-                end.b = blendColor(src.b, color.b, color.a);
-                end.a = color.a + (src.a * (0xF - color.a) / 0xF);
+                // The frame clip never exceeds the framebuffer
+                const auto& frameClip = this->m_frameClip;
+                if (!render::clipSpan(x, x_end, y, frameClip.x, frameClip.y, frameClip.w, frameClip.h))
+                    return;
+                
+                if (!this->m_scissoringStack.empty()) {
+                    const auto& currScissorConfig = this->m_scissoringStack.top();
+                    if (!render::clipSpan(x, x_end, y, currScissorConfig.x, currScissorConfig.y, currScissorConfig.w, currScissorConfig.h))
+                        return;
+                }
+                
+                render::forEachSpanGroup(static_cast<u16*>(this->getCurrentFramebuffer()), x, x_end, y, func);
+            }
+            
+            /**
+             * @brief Calls func(pixel, x) for every visible pixel of a horizontal run
+             *
+             * @param x X start pos
+             * @param y Y pos
+             * @param w Width of the run
+             * @param func Pixel function, receives a reference to the framebuffer pixel and its x pos
+             */
+            template<typename Func>
+            inline void forEachSpanPixel(const s32 x, const s32 y, const s32 w, Func&& func) {
+                this->forEachSpanGroup(x, y, w, [&func](u16* pixels, s32 px, s32 count) {
+                    for (s32 i = 0; i < count; ++i)
+                        func(pixels[i], px + i);
+                });
+            }
+            
+            /**
+             * @brief Draws a destination blended horizontal run of pixels
+             *
+             * @param x X start pos
+             * @param y Y pos
+             * @param w Width of the run
+             * @param tables Tables of the color
+             */
+            inline void drawSpanBlendDst(const s32 x, const s32 y, const s32 w, const BlendDstTables& tables) {
+                this->forEachSpanGroup(x, y, w, [&tables](u16* pixels, s32, s32 count) {
+                    blendDstPixels(pixels, count, tables);
+                });
+            }
             
-                this->setPixel(x, y, end, offset);
+            /**
+             * @brief Draws a destination blended horizontal run of pixels
+             *
+             * @param x X start pos
+             * @param y Y pos
+             * @param w Width of the run
+             * @param color Color
+             */
+            inline void drawSpanBlendDst(const s32 x, const s32 y, const s32 w, const Color& color) {
+                // Building the tables only pays off for longer runs
+                if (w < render::BlendDstTablesMinWidth) {
+                    this->forEachSpanPixel(x, y, w, [this, &color](u16& pixel, s32) {
+                        pixel = this->blendDst(pixel, color);
+                    });
+                } else {
+                    this->drawSpanBlendDst(x, y, w, this->makeBlendDstTables(color));
+                }
             }
+            // CUSTOM MODIFICATION END
             
             /**
              * @brief Draws a rectangle of given sizes
@@ -2547,10 +2665,9 @@ namespace tsl {
                 s32 x_end = x + w;
                 s32 y_end = y + h;
             
+                const BlendDstTables tables = this->makeBlendDstTables(color); // CUSTOM MODIFICATION
                 for (s32 yi = y; yi < y_end; ++yi) {
-                    for (s32 xi = x; xi < x_end; ++xi) {
-                        this->setPixelBlendDst(xi, yi, color);
-                    }
+                    this->drawSpanBlendDst(x, yi, x_end - x, tables);
                 }
             }
 
@@ -2564,15 +2681,11 @@ namespace tsl {
                 
                 while (x >= y) {
                     if (filled) {
-                        for (s32 i = centerX - x; i <= centerX + x; i++) {
-                            this->setPixelBlendDst(i, centerY + y, color);
-                            this->setPixelBlendDst(i, centerY - y, color);
-                        }
+                        this->drawSpanBlendDst(centerX - x, centerY + y, 2 * x + 1, color);
+                        this->drawSpanBlendDst(centerX - x, centerY - y, 2 * x + 1, color);
                         
-                        for (s32 i = centerX - y; i <= centerX + y; i++) {
-                            this->setPixelBlendDst(i, centerY + x, color);
-                            this->setPixelBlendDst(i, centerY - x, color);
-                        }
+                        this->drawSpanBlendDst(centerX - y, centerY + x, 2 * y + 1, color);
+                        this->drawSpanBlendDst(centerX - y, centerY - x, 2 * y + 1, color);
                     } else {
                         this->setPixelBlendDst(centerX + x, centerY + y, color);
                         this->setPixelBlendDst(centerX + y, centerY + x, color);
@@ -2607,36 +2720,20 @@ namespace tsl {
                     if (filled) {
                         switch (quadrant) {
                             case 1: // Top-right
-                                for (s32 i = centerX; i <= centerX + x; i++) {
-                                    this->setPixelBlendDst(i, centerY - y, color);
-                                }
-                                for (s32 i = centerX; i <= centerX + y; i++) {
-                                    this->setPixelBlendDst(i, centerY - x, color);
-                                }
+                                this->drawSpanBlendDst(centerX, centerY - y, x + 1, color);
+                                this->drawSpanBlendDst(centerX, centerY - x, y + 1, color);
                                 break;
                             case 2: // Top-left
-                                for (s32 i = centerX - x; i <= centerX; i++) {
-                                    this->setPixelBlendDst(i, centerY - y, color);
-                                }
-                                for (s32 i = centerX - y; i <= centerX; i++) {
-                                    this->setPixelBlendDst(i, centerY - x, color);
-                                }
+                                this->drawSpanBlendDst(centerX - x, centerY - y, x + 1, color);
+                                this->drawSpanBlendDst(centerX - y, centerY - x, y + 1, color);
                                 break;
                             case 3: // Bottom-left
-                                for (s32 i = centerX - x; i <= centerX; i++) {
-                                    this->setPixelBlendDst(i, centerY + y, color);
-                                }
-                                for (s32 i = centerX - y; i <= centerX; i++) {
-                                    this->setPixelBlendDst(i, centerY + x, color);
-                                }
+                                this->drawSpanBlendDst(centerX - x, centerY + y, x + 1, color);
+                                this->drawSpanBlendDst(centerX - y, centerY + x, y + 1, color);
                                 break;
                             case 4: // Bottom-right
-                                for (s32 i = centerX; i <= centerX + x; i++) {
-                                    this->setPixelBlendDst(i, centerY + y, color);
-                                }
-                                for (s32 i = centerX; i <= centerX + y; i++) {
-                                    this->setPixelBlendDst(i, centerY + x, color);
-                                }
+                                this->drawSpanBlendDst(centerX, centerY + y, x + 1, color);
+                                this->drawSpanBlendDst(centerX, centerY + x, y + 1, color);
                                 break;
                         }
                     } else {
@@ -2699,6 +2796,38 @@ namespace tsl {
                 s32 y_top = y + radius;
                 s32 y_bottom = y_end - radius;
                 
+                // CUSTOM MODIFICATION START
+                // Every row is a single span as long as opposite corners don't overlap
+                if (x_left <= x_right && y_top <= y_bottom) {
+                    const BlendDstTables tables = self->makeBlendDstTables(color);
+                    for (s32 y1 = startRow; y1 < endRow; ++y1) {
+                        s32 span_start = x;
+                        s32 span_end = x_end;
+                        
+                        if (y1 < y_top || y1 >= y_bottom) {
+                            const s32 dy = (y1 < y_top) ? (y_top - y1) : (y1 - y_bottom);
+                            const s32 rem = r2 - dy * dy;
+                            
+                            // Largest dx with dx * dx <= rem, -1 if there is none
+                            s32 dx = -1;
+                            if (rem >= 0) {
+                                dx = static_cast<s32>(std::sqrt(static_cast<float>(rem)));
+                                while (dx * dx > rem)
+                                    --dx;
+                                while ((dx + 1) * (dx + 1) <= rem)
+                                    ++dx;
+                            }
+                            
+                            span_start = std::max(x, x_left - std::max(dx, 0));
+                            span_end = std::min(x_end, x_right + dx + 1);
+                        }
+                        
+                        self->drawSpanBlendDst(span_start, y1, span_end - span_start, tables);
+                    }
+                    return;
+                }
+                // CUSTOM MODIFICATION END
+                
                 // Process the rectangle in chunks
                 for (s32 y1 = startRow; y1 < endRow; ++y1) {
                     for (s32 x1 = x; x1 < x_end; ++x1) {
@@ -2781,28 +2910,11 @@ namespace tsl {
                 s32 y_end = y + h;
                 s32 r2 = radius * radius;
             
-                // Reuse threads and implement work-stealing
-                currentRow = y;
-            
-                auto threadTask = [this, x, y, x_end, y_end, r2, radius, color]() {
-                    s32 startRow;
-                    while (true) {
-                        startRow = currentRow.fetch_add(4);
-                        if (startRow >= y_end) break;
-                        //s32 endRow = std::min(startRow + 4,y_end); // Process one row at a time
-                        processRoundedRectChunk(this, x, y, x_end, y_end, r2, radius, color, startRow, std::min(startRow + 4,y_end));
-                    }
+                // Hand out bands of 4 rows to the persistent workers // CUSTOM MODIFICATION
+                auto band = [this, x, y, x_end, y_end, r2, radius, &color](s32 startRow, s32 endRow) {
+                    processRoundedRectChunk(this, x, y, x_end, y_end, r2, radius, color, startRow, endRow);
                 };
-            
-                // Launch threads
-                for (unsigned i = 0; i < numThreads; ++i) {
-                    threads[i] = std::thread(threadTask);
-                }
-            
-                // Join threads
-                for (auto& t : threads) {
-                    if (t.joinable()) t.join();
-                }
+                renderWorkers.run(y, y_end, 4, band);
             }
 
 
@@ -2882,31 +2994,21 @@ namespace tsl {
             
                 // Draw the central rectangle excluding the corners
                 for (s32 y1 = y_start; y1 < y_end; ++y1) {
-                    for (s32 x1 = x_start; x1 < x_end; ++x1) {
-                        this->setPixelBlendDst(x1, y1, color);
-                    }
+                    this->drawSpanBlendDst(x_start, y1, x_end - x_start, color);
                 }
             
                 // Draw the top and bottom rectangles excluding the corners
                 for (s32 y1 = y; y1 < y_start; ++y1) {
-                    for (s32 x1 = x_start; x1 < x_end; ++x1) {
-                        this->setPixelBlendDst(x1, y1, color);
-                    }
+                    this->drawSpanBlendDst(x_start, y1, x_end - x_start, color);
                 }
                 for (s32 y1 = y_end; y1 < y + h; ++y1) {
-                    for (s32 x1 = x_start; x1 < x_end; ++x1) {
-                        this->setPixelBlendDst(x1, y1, color);
-                    }
+                    this->drawSpanBlendDst(x_start, y1, x_end - x_start, color);
                 }
             
                 // Draw the left and right rectangles excluding the corners
                 for (s32 y1 = y_start; y1 < y_end; ++y1) {
-                    for (s32 x1 = x; x1 < x_start; ++x1) {
-                        this->setPixelBlendDst(x1, y1, color);
-                    }
-                    for (s32 x1 = x_end; x1 < x + w; ++x1) {
-                        this->setPixelBlendDst(x1, y1, color);
-                    }
+                    this->drawSpanBlendDst(x, y1, x_start - x, color);
+                    this->drawSpanBlendDst(x_end, y1, x + w - x_end, color);
                 }
                 
                 // Draw the rounded corners ensuring smooth arcs
@@ -2931,82 +3033,131 @@ namespace tsl {
             }
 
             
-            inline void processBMPChunk(const s32 x, const s32 y, const s32 screenW, const u8 *preprocessedData, const s32 startRow, const s32 endRow) {
-                s32 bytesPerRow = screenW * 4;
-                const s32 endX = screenW - 16;
+            /**
+             * @brief Fills the entire layer with a given color
+             * @note Only the damaged part of the current frame is filled
+             *
+             * @param color Color
+             */
+            inline void fillScreen(const Color& color) {
+                if (this->isFullFrame()) {
+                    std::fill_n(static_cast<Color*>(this->getCurrentFramebuffer()), this->getFramebufferSize() / sizeof(Color), color);
+                    return;
+                }
                 
-                for (s32 y1 = startRow; y1 < endRow; ++y1) {
-                    const u8 *rowPtr = preprocessedData + (y1 * bytesPerRow);
-                    s32 x1 = 0;
+                // Only fill the damaged area // CUSTOM MODIFICATION
+                for (s32 y = this->m_frameClip.y; y < this->m_frameClip.y + this->m_frameClip.h; ++y) {
+                    this->forEachSpanGroup(this->m_frameClip.x, y, this->m_frameClip.w, [&color](u16* pixels, s32, s32 count) {
+                        std::fill_n(pixels, count, color.rgba);
+                    });
+                }
+            }
+            
+            // CUSTOM MODIFICATION START
+            /**
+             * @brief Loads an RGBA8888 wallpaper and caches it blended over the background color in framebuffer layout
+             *
+             * @param filePath Wallpaper file, sized like the framebuffer
+             */
+            static void loadWallpaperFile(const std::string& filePath) {
+                wallpaperData.clear();
+                
+                std::ifstream file(filePath, std::ios::binary);
+                if (!file)
+                    return;
+                
+                // The framebuffer is allocated in blocks of 128 rows
+                const s32 width = cfg::FramebufferWidth;
+                const s32 height = cfg::FramebufferHeight;
+                const Color background = defaultBackgroundColor;
+                std::vector<u16> cache(width * ((height + 127) & ~127), background.rgba);
+                std::vector<u8> row(width * 4);
+                
+                for (s32 y = 0; y < height; ++y) {
+                    if (!file.read(reinterpret_cast<char*>(row.data()), row.size()))
+                        return;
                     
-                    // Process in chunks of 16 pixels using SIMD
-                    for (; x1 <= endX; x1 += 16) {
-                        uint8x16x4_t pixelData = vld4q_u8(rowPtr + (x1 * 4));
+                    const u32 rowOffset = getRowOffset(y);
+                    for (s32 x = 0; x < width; ++x) {
+                        const u8* p = &row[x * 4];
+                        const u8 alpha = p[3] >> 4;
                         
-                        // Unroll the loop to reduce the number of operations
-                        for (s32 i = 0; i < 16; ++i) {
-                            setPixelBlendSrc(x + x1 + i, y + y1, {
-                                pixelData.val[0][i],
-                                pixelData.val[1][i],
-                                pixelData.val[2][i],
-                                pixelData.val[3][i]
-                            });
-                        }
-                    }
-            
-                    // Handle the remaining pixels (less than 16)
-                    for (s32 xRem = x1; xRem < screenW; ++xRem) {
-                        const u8 *p = rowPtr + (xRem * 4);
-                        setPixelBlendSrc(x + xRem, y + y1, {p[0], p[1], p[2], p[3]});
+                        Color pixel = background;
+                        pixel.r = blendColor(background.r, p[0] >> 4, alpha);
+                        pixel.g = blendColor(background.g, p[1] >> 4, alpha);
+                        pixel.b = blendColor(background.b, p[2] >> 4, alpha);
+                        cache[rowOffset + getColumnOffset(x)] = pixel.rgba;
                     }
                 }
-                //inPlot.store(false, std::memory_order_release);
-                inPlotBarrier.arrive_and_wait(); // Wait for all threads to reach this point
+                
+                wallpaperData = std::move(cache);
+                wallpaperBackground = background.rgba;
             }
-
-
+            
             /**
-             * @brief Draws a scaled RGBA8888 bitmap from memory
+             * @brief Checks whether the wallpaper cache was blended over the current background color
+             * @note initializeThemeVars may change the background color after the wallpaper was loaded
              *
-             * @param x X start position
-             * @param y Y start position
-             * @param w Bitmap width (original width of the bitmap)
-             * @param h Bitmap height (original height of the bitmap)
-             * @param bmp Pointer to bitmap data
-             * @param screenW Target screen width
-             * @param screenH Target screen height
+             * @return False if the cache is empty or has to be reloaded
              */
-
-            inline void drawBitmap(const s32 x, const s32 y, const s32 screenW, const s32 screenH, const u8 *preprocessedData) {
-                // Number of threads to use
-                //const unsigned numThreads = 3;
-                //std::vector<std::thread> threads(numThreads);
-
-                // Divide rows among threads
-                //s32 chunkSize = (screenH + numThreads - 1) / numThreads;
-                for (unsigned i = 0; i < numThreads; ++i) {
-                    s32 startRow = i * bmpChunkSize;
-                    s32 endRow = std::min(startRow + bmpChunkSize, screenH);
-                    
-                    // Bind the member function and create the thread
-                    threads[i] = std::thread(std::bind(&tsl::gfx::Renderer::processBMPChunk, this, x, y, screenW, preprocessedData, startRow, endRow));
-                }
+            static bool isWallpaperCurrent() {
+                return !wallpaperData.empty() && (wallpaperBackground & 0x0FFF) == (defaultBackgroundColor.rgba & 0x0FFF);
+            }
             
-                // Join all threads
-                for (auto& t : threads) {
-                    t.join();
+            /**
+             * @brief Draws the background color and the cached wallpaper, replaces fillScreen for the frame background
+             *
+             * @return False if no wallpaper is cached for the current background color
+             */
+            inline bool drawWallpaper() {
+                if (!isWallpaperCurrent())
+                    return false;
+                
+                u16* framebuffer = static_cast<u16*>(this->getCurrentFramebuffer());
+                const u16* cache = wallpaperData.data();
+                const u16 alpha = a(defaultBackgroundColor).a;
+                
+                if (this->isFullFrame()) {
+                    copyWallpaperPixels(framebuffer, cache, std::min(wallpaperData.size(), this->getFramebufferSize() / sizeof(u16)), alpha);
+                    return true;
+                }
+                
+                // The cache shares the framebuffer layout, so damaged groups map to the same offsets
+                for (s32 y = this->m_frameClip.y; y < this->m_frameClip.y + this->m_frameClip.h; ++y) {
+                    this->forEachSpanGroup(this->m_frameClip.x, y, this->m_frameClip.w, [framebuffer, cache, alpha](u16* pixels, s32, s32 count) {
+                        copyWallpaperPixels(pixels, cache + (pixels - framebuffer), count, alpha);
+                    });
                 }
+                
+                return true;
             }
-
             
             /**
-             * @brief Fills the entire layer with a given color
+             * @brief Copies cached wallpaper pixels, replacing their alpha if the background is fading
              *
-             * @param color Color
+             * @param pixels Framebuffer pixels
+             * @param cache Cached wallpaper pixels
+             * @param count Number of pixels
+             * @param alpha Current background alpha
              */
-            inline void fillScreen(const Color& color) {
-                std::fill_n(static_cast<Color*>(this->getCurrentFramebuffer()), this->getFramebufferSize() / sizeof(Color), color);
+            static inline void copyWallpaperPixels(u16* pixels, const u16* cache, const size_t count, const u16 alpha) {
+                if (alpha == (wallpaperBackground >> 12)) {
+                    std::memcpy(pixels, cache, count * sizeof(u16));
+                    return;
+                }
+                
+                // Fading only lowers the background alpha, blending the wallpaper keeps it as is
+                size_t i = 0;
+            #if defined(__ARM_NEON)
+                const uint16x8_t colorMask = vdupq_n_u16(0x0FFF);
+                const uint16x8_t alphaBits = vdupq_n_u16(alpha << 12);
+                for (; i + 8 <= count; i += 8)
+                    vst1q_u16(pixels + i, vorrq_u16(vandq_u16(vld1q_u16(cache + i), colorMask), alphaBits));
+            #endif
+                for (; i < count; ++i)
+                    pixels[i] = (cache[i] & 0x0FFF) | (alpha << 12);
             }
+            // CUSTOM MODIFICATION END
             
             /**
              * @brief Clears the layer (With transparency)
@@ -3143,9 +3294,6 @@ namespace tsl {
                 
                 float xPos = 0;
                 float yPos = 0;
-                u32 rowOffset = 0;
-                uint8_t bmpColor = 0;
-                Color tmpColor(0);
                 
                 // Static glyph cache
                 static std::unordered_map<u64, Glyph> s_glyphCache; // may cause leak? will investigate later.
@@ -3211,20 +3359,14 @@ namespace tsl {
                         xPos = currX + glyph->bounds[0];
                         yPos = currY + glyph->bounds[1];
             
-                        // Optimized pixel processing
+                        // Blit one clipped glyph row at a time // CUSTOM MODIFICATION
+                        const s32 glyphX = static_cast<s32>(xPos);
+                        const s32 glyphY = static_cast<s32>(yPos);
                         for (s32 bmpY = 0; bmpY < glyph->height; ++bmpY) {
-                            rowOffset = bmpY * glyph->width;
-                            for (s32 bmpX = 0; bmpX < glyph->width; ++bmpX) {
-                                bmpColor = glyph->glyphBmp[rowOffset + bmpX] >> 4;
-                                if (bmpColor == 0xF) {
-                                    // Direct pixel manipulation
-                                    this->setPixel(xPos + bmpX, yPos + bmpY, color, this->getPixelOffset(xPos + bmpX, yPos + bmpY));
-                                } else if (bmpColor != 0x0) {
-                                    tmpColor = color;
-                                    tmpColor.a = bmpColor;
-                                    this->setPixelBlendDst(xPos + bmpX, yPos + bmpY, tmpColor);
-                                }
-                            }
+                            const u8* glyphRow = glyph->glyphBmp + bmpY * glyph->width;
+                            this->forEachSpanGroup(glyphX, glyphY + bmpY, glyph->width, [&](u16* pixels, s32 px, s32 count) {
+                                this->blendCoveragePixels(pixels, glyphRow + (px - glyphX), count, color);
+                            });
                         }
                     }
             
@@ -3385,6 +3527,9 @@ namespace tsl {
             inline static void setOpacity(float opacity) {
                 opacity = std::clamp(opacity, 0.0F, 1.0F);
                 
+                if (opacity != Renderer::s_opacity) // CUSTOM MODIFICATION
+                    markAllDirty();
+                
                 Renderer::s_opacity = opacity;
             }
             
@@ -3399,6 +3544,11 @@ namespace tsl {
             
             std::stack<ScissoringConfig> m_scissoringStack;
             
+            // CUSTOM MODIFICATION START
+            ScissoringConfig m_frameClip = { 0, 0, 0, 0 };                // Part of the current frame that gets redrawn
+            static inline render::FrameDamage s_frameDamage;              // Marked damage and what each of the two framebuffers created in init has not received yet
+            // CUSTOM MODIFICATION END
+            
             stbtt_fontinfo m_stdFont, m_localFont, m_extFont;
             bool m_hasLocalFont = false;
             
@@ -3468,6 +3618,28 @@ namespace tsl {
                 eventWait(&this->m_vsyncEvent, UINT64_MAX);
             }
             
+            // CUSTOM MODIFICATION START
+            /**
+             * @brief Part of the swizzled framebuffer offset that only depends on y
+             *
+             * @param y Y pos
+             * @return Offset
+             */
+            static inline u32 getRowOffset(const s32 y) {
+                return render::getRowOffset(y);
+            }
+            
+            /**
+             * @brief Part of the swizzled framebuffer offset that only depends on x, pixels x to x | 7 are contiguous
+             *
+             * @param x X pos
+             * @return Offset
+             */
+            static inline u32 getColumnOffset(const s32 x) {
+                return render::getColumnOffset(x);
+            }
+            // CUSTOM MODIFICATION END
+            
             /**
              * @brief Decodes a x and y coordinate into a offset into the swizzled framebuffer
              *
@@ -3476,6 +3648,13 @@ namespace tsl {
              * @return Offset
              */
             inline u32 getPixelOffset(const s32 x, const s32 y) {
+                // Skip pixels outside of the damaged area // CUSTOM MODIFICATION
+                if (x < this->m_frameClip.x || y < this->m_frameClip.y ||
+                    x >= this->m_frameClip.x + this->m_frameClip.w ||
+                    y >= this->m_frameClip.y + this->m_frameClip.h) {
+                    return UINT32_MAX;
+                }
+                
                 // Check for scissoring boundaries
                 if (!this->m_scissoringStack.empty()) {
                     const auto& currScissorConfig = this->m_scissoringStack.top();
@@ -3488,13 +3667,7 @@ namespace tsl {
             
                 // Calculate the base offset
                 //tmpPos = (((y & 127) / 16) + ((x / 32) * 8) + ((y / 128) * (cfg::FramebufferWidth / 4)))*1024;
-                return (((y & 127) / 16) + ((x / 32) * 8) + ((y / 128) * 112))*512 +
-                        ((y % 16) / 8) * 256 + 
-                        ((x % 32) / 16) * 128 + 
-                        ((y % 8) / 2) * 32 + 
-                        ((x % 16) / 8) * 16 + 
-                        (y % 2) * 8 + 
-                        (x % 8);
+                return getRowOffset(y) + getColumnOffset(x); // CUSTOM MODIFICATION
                 //tmpPos *= 1024; // 16 * 16 * 4 = 1024
             
                 // Calculate the fine offset and add it to the base offset
@@ -3559,6 +3732,8 @@ namespace tsl {
                     setExit();
                 });
                 
+                renderWorkers.start(); // CUSTOM MODIFICATION
+                
                 this->m_initialized = true;
             }
             
@@ -3570,6 +3745,8 @@ namespace tsl {
                 if (!this->m_initialized)
                     return;
                 
+                renderWorkers.stop(); // CUSTOM MODIFICATION
+                
                 framebufferClose(&this->m_framebuffer);
                 nwindowClose(&this->m_window);
                 viDestroyManagedLayer(&this->m_layer);
@@ -3636,7 +3813,34 @@ namespace tsl {
              */
             inline void startFrame() {
                 this->m_currentFramebuffer = framebufferBegin(&this->m_framebuffer, nullptr);
+                this->m_frameClip = { 0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight }; // CUSTOM MODIFICATION
+            }
+            
+            // CUSTOM MODIFICATION START
+            /**
+             * @brief Starts a new frame that only redraws the damage its framebuffer has not received yet
+             * @note When nothing has to be redrawn this only waits for vsync and returns false, don't call \ref endFrame then
+             *
+             * @return Whether a frame was started
+             */
+            inline bool startDamagedFrame() {
+                if (!Renderer::s_frameDamage.collect()) {
+                    this->waitForVSync();
+                    return false;
+                }
+                
+                this->startFrame();
+                this->m_frameClip = Renderer::s_frameDamage.take(this->getCurrentFramebufferSlot(), cfg::FramebufferWidth, cfg::FramebufferHeight);
+                
+                // The dequeued framebuffer can already be up to date
+                if (this->m_frameClip.w == 0 || this->m_frameClip.h == 0) {
+                    this->endFrame();
+                    return false;
+                }
+                
+                return true;
             }
+            // CUSTOM MODIFICATION END
             
             /**
              * @brief End the current frame
@@ -3777,6 +3981,7 @@ namespace tsl {
             void inline frame(gfx::Renderer *renderer) {
                 
                 if (this->m_focused) {
+                    this->markDirty(); // The highlight is animated // CUSTOM MODIFICATION
                     renderer->enableScissoring(0, 97, tsl::cfg::FramebufferWidth, tsl::cfg::FramebufferHeight-73-97);
                     this->drawFocusBackground(renderer);
                     this->drawHighlight(renderer);
@@ -3793,12 +3998,26 @@ namespace tsl {
             void inline invalidate() {
                 const auto& parent = this->getParent();
                 
+                this->markDirty(); // CUSTOM MODIFICATION
+                
                 if (parent == nullptr)
                     this->layout(0, 0, cfg::FramebufferWidth, cfg::FramebufferHeight);
                 else
                     this->layout(ELEMENT_BOUNDS(parent));
+                
+                this->markDirty(); // CUSTOM MODIFICATION
             }
             
+            // CUSTOM MODIFICATION START
+            /**
+             * @brief Marks the element for redrawing, including the space its highlight can take up
+             * @note Call this when the element changes outside of input handling, otherwise it is only redrawn with the next input
+             */
+            virtual void markDirty() {
+                gfx::Renderer::markDirty(this->getX() - HighlightMargin, this->getY() - HighlightMargin, this->getWidth() + 2 * HighlightMargin, this->getHeight() + 2 * HighlightMargin);
+            }
+            // CUSTOM MODIFICATION END
+            
             /**
              * @brief Shake the highlight in the given direction to signal that the focus cannot move there
              *
@@ -4166,6 +4385,7 @@ namespace tsl {
             virtual inline void setFocused(bool focused) {
                 this->m_focused = focused;
                 this->m_clickAnimationProgress = 0;
+                this->markDirty(); // CUSTOM MODIFICATION
             }
             
             
@@ -4175,6 +4395,7 @@ namespace tsl {
             
         protected:
             constexpr static inline auto a = &gfx::Renderer::a;
+            static constexpr s32 HighlightMargin = 16; // Highlight border plus shake amplitude outside the bounds // CUSTOM MODIFICATION
             bool m_focused = false;
             u8 m_clickAnimationProgress = 0;
             
@@ -4348,8 +4569,9 @@ namespace tsl {
                     // Wait for inPlot to be false before reloading the wallpaper
                     cv.wait(lock, [] { return (!inPlot.load(std::memory_order_acquire) && !refreshWallpaper.load(std::memory_order_acquire)); });
 
-                    if (wallpaperData.empty() && isFileOrDirectory(WALLPAPER_PATH)) {
-                        loadWallpaperFile(WALLPAPER_PATH);
+                    // Also reloads after a theme change, the cache contains the background color // CUSTOM MODIFICATION
+                    if (!gfx::Renderer::isWallpaperCurrent() && isFileOrDirectory(WALLPAPER_PATH)) {
+                        gfx::Renderer::loadWallpaperFile(WALLPAPER_PATH); // CUSTOM MODIFICATION
                     }
                 }
 
@@ -4380,23 +4602,19 @@ namespace tsl {
             virtual void draw(gfx::Renderer *renderer) override {
                 if (m_noClickableItems != noClickableItems)
                     noClickableItems = m_noClickableItems;
-                renderer->fillScreen(a(defaultBackgroundColor));
-                
+                // The cached wallpaper already contains the background color // CUSTOM MODIFICATION
+                bool wallpaperDrawn = false;
                 if (expandedMemory && !refreshWallpaper.load(std::memory_order_acquire)) {
                     //inPlot = true;
                     inPlot.store(true, std::memory_order_release);
                     //std::lock_guard<std::mutex> lock(wallpaperMutex);
-                    if (!wallpaperData.empty()) {
-                        // Draw the bitmap at position (0, 0) on the screen
-                        if (!refreshWallpaper.load(std::memory_order_acquire))
-                            renderer->drawBitmap(0, 0, 448, 720, wallpaperData.data());
-                        else
-                            inPlot.store(false, std::memory_order_release);
-                    } else {
-                        inPlot.store(false, std::memory_order_release);
-                    }
+                    if (!refreshWallpaper.load(std::memory_order_acquire))
+                        wallpaperDrawn = renderer->drawWallpaper();
+                    inPlot.store(false, std::memory_order_release);
                     //inPlot = false;
                 }
+                if (!wallpaperDrawn)
+                    renderer->fillScreen(a(defaultBackgroundColor));
                 
 
                 y = 50;
@@ -4406,6 +4624,10 @@ namespace tsl {
                                     this->m_subtitle.find("Ultrahand Package") == std::string::npos && 
                                     this->m_subtitle.find("Ultrahand Script") == std::string::npos);
 
+                // The logo, clock and status readouts change without input // CUSTOM MODIFICATION
+                if (isUltrahand || this->m_colorSelection == "ultra")
+                    gfx::Renderer::markDirty(0, 0, tsl::cfg::FramebufferWidth, 97);
+                
                 if (isUltrahand) {
 
                     if (touchingMenu && inMainMenu) {
@@ -5010,6 +5232,8 @@ namespace tsl {
                         element->invalidate();
                         if (index >= 0 && index < static_cast<int>(this->m_items.size())) {
                             this->m_items.insert(this->m_items.cbegin() + index, element);
+                            if (index <= this->m_focusedIndex) // CUSTOM MODIFICATION: keep focused element in sync
+                                this->m_focusedIndex++;
                         } else {
                             this->m_items.push_back(element);
                         }
@@ -5039,7 +5263,8 @@ namespace tsl {
                 renderer->enableScissoring(this->getLeftBound(), topBound, width + 4, height + 4);
             
                 for (auto& entry : this->m_items) {
-                    if (entry->getBottomBound() > topBound && entry->getTopBound() < bottomBound) {
+                    if (entry->getBottomBound() > topBound && entry->getTopBound() < bottomBound &&
+                        renderer->isDirty(entry->getX() - HighlightMargin, entry->getY() - HighlightMargin, entry->getWidth() + 2 * HighlightMargin, entry->getHeight() + 2 * HighlightMargin)) { // CUSTOM MODIFICATION
                         entry->frame(renderer);
                     }
                 }
@@ -5179,6 +5404,7 @@ namespace tsl {
                     element->invalidate();
                     
                     this->m_itemsToAdd.emplace_back(index, element);
+                    this->markDirty(); // CUSTOM MODIFICATION
                 }
             }
             
@@ -5190,8 +5416,10 @@ namespace tsl {
              * @param element Element to remove from list. Call \ref Gui::removeFocus before.
              */
             virtual void removeItem(Element *element) {
-                if (element != nullptr)
+                if (element != nullptr) {
                     this->m_itemsToRemove.emplace_back(element);
+                    this->markDirty(); // CUSTOM MODIFICATION
+                }
             }
             
             /**
@@ -5210,6 +5438,15 @@ namespace tsl {
              */
             inline void clear() {
                 this->m_clearList = true;
+                this->markDirty(); // CUSTOM MODIFICATION
+            }
+            
+            /**
+             * @brief Marks the list for redrawing, including the scrollbar right of it
+             */
+            virtual void markDirty() override { // CUSTOM MODIFICATION
+                Element::markDirty();
+                gfx::Renderer::markDirty(this->getRightBound(), this->getY(), 32, this->getHeight() + 8);
             }
             
 
@@ -5621,6 +5858,8 @@ namespace tsl {
                     element->invalidate();
                     if (index >= 0 && (this->m_items.size() > static_cast<size_t>(index))) {
                         this->m_items.insert(this->m_items.cbegin() + static_cast<size_t>(index), element);
+                        if (static_cast<size_t>(index) <= this->m_focusedIndex) // CUSTOM MODIFICATION: keep focused element in sync
+                            this->m_focusedIndex++;
                     } else {
                         this->m_items.push_back(element);
                     }
@@ -5921,6 +6160,7 @@ namespace tsl {
                 this->m_scrollText = "";
                 this->m_ellipsisText = "";
                 this->m_maxWidth = 0;
+                this->markDirty(); // CUSTOM MODIFICATION
             }
             
             /**
@@ -5933,6 +6173,7 @@ namespace tsl {
                 this->m_value = value;
                 this->m_faint = faint;
                 this->m_maxWidth = 0;
+                this->markDirty(); // CUSTOM MODIFICATION
             }
             
             /**
@@ -6140,6 +6381,7 @@ namespace tsl {
             
             inline void setText(const std::string &text) {
                 this->m_text = text;
+                this->markDirty(); // CUSTOM MODIFICATION
             }
             
             inline const std::string& getText() const {
@@ -6566,6 +6808,7 @@ namespace tsl {
             
             virtual void setProgress(u8 value) {
                 this->m_value = value;
+                this->markDirty(); // CUSTOM MODIFICATION
             }
             
             void setValueChangedListener(std::function<void(u8)> valueChangedListener) {
@@ -6759,6 +7002,7 @@ namespace tsl {
             virtual void setProgress(u8 value) override {
                 value = std::min(value, u8(this->m_numSteps - 1));
                 this->m_value = value * (100 / (this->m_numSteps - 1));
+                this->markDirty(); // CUSTOM MODIFICATION
             }
             
         //protected:
@@ -7259,10 +7503,13 @@ namespace tsl {
         void loop() {
             auto& renderer = gfx::Renderer::get();
             
-            renderer.startFrame();
-            
             this->animationLoop();
             this->getCurrentGui()->update();
+            
+            // Only redraw what changed since this framebuffer was last drawn // CUSTOM MODIFICATION
+            if (!renderer.startDamagedFrame())
+                return;
+            
             this->getCurrentGui()->draw(&renderer);
             
             renderer.endFrame();
@@ -7294,6 +7541,10 @@ namespace tsl {
             static const auto clickThreshold = std::chrono::milliseconds(340); // Adjust this value as needed
             static auto keyEventInterval = std::chrono::milliseconds(67); // Interval between key events
             
+            // Any input can change what gets drawn // CUSTOM MODIFICATION
+            if (keysDown || keysHeld || touchDetected || oldTouchDetected)
+                gfx::Renderer::markAllDirty();
+            
             auto& currentGui = this->getCurrentGui();
             
             // Return early if current GUI is not available
@@ -7544,6 +7795,8 @@ namespace tsl {
             renderer.startFrame();
             renderer.clearScreen();
             renderer.endFrame();
+            
+            gfx::Renderer::markAllDirty(); // CUSTOM MODIFICATION
         }
         
         /**
@@ -7581,6 +7834,7 @@ namespace tsl {
             
             // Push the new Gui onto the stack
             this->m_guiStack.push(std::move(gui));
+            gfx::Renderer::markAllDirty(); // CUSTOM MODIFICATION
             
             return this->m_guiStack.top();
         }
@@ -7614,11 +7868,15 @@ namespace tsl {
             
             if (this->m_guiStack.empty())
                 this->close();
+            
+            gfx::Renderer::markAllDirty(); // CUSTOM MODIFICATION
         }
 
         void pop() {
             if (!this->m_guiStack.empty())
                 this->m_guiStack.pop();
+            
+            gfx::Renderer::markAllDirty(); // CUSTOM MODIFICATION
         }
         
         template<typename G, typename ...Args>
@@ -0,0 +1,509 @@
+/********************************************************************************
+ * Custom Fork Information
+ *
+ * File: tesla_render.hpp
+ * Description:
+ *   Pixel kernels and renderer worker threads of the libtesla fork, kept free of
+ *   the rest of tesla.hpp so they also build for host tests and benchmarks.
+ *   Pixels are RGBA4444 with r in bits 0-3, g in 4-7, b in 8-11 and a in 12-15,
+ *   the same layout as tsl::gfx::Color.
+ ********************************************************************************/
+
+/**
+ * Copyright (C) 2020 werwolv
+ *
+ * This file is part of libtesla.
+ *
+ * libtesla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * libtesla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libtesla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <switch.h>
+#include <arm_neon.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <thread>
+#include <vector>
+
+namespace tsl::gfx::render {
+
+    /**
+     * @brief Blends two color nibbles
+     *
+     * @param src Source nibble
+     * @param dst Destination nibble
+     * @param alpha Opacity
+     * @return Blended nibble
+     */
+    constexpr inline u8 blendColor(const u8 src, const u8 dst, const u8 alpha) {
+        return (dst * alpha + src * (0x0F - alpha)) >> 4;
+    }
+
+    /**
+     * @brief Blends a color over a framebuffer pixel, accumulating alpha
+     *
+     * @param dst Framebuffer pixel
+     * @param color Color
+     * @return Blended pixel
+     */
+    constexpr inline u16 blendDst(const u16 dst, const u16 color) {
+        const u8 alpha = color >> 12;
+
+        const u16 r = blendColor(dst & 0xF, color & 0xF, alpha);
+        const u16 g = blendColor((dst >> 4) & 0xF, (color >> 4) & 0xF, alpha);
+        const u16 b = blendColor((dst >> 8) & 0xF, (color >> 8) & 0xF, alpha);
+        const u16 a = (alpha + ((dst >> 12) * (0xF - alpha) / 0xF)) & 0xF;
+
+        return r | (g << 4) | (b << 8) | (a << 12);
+    }
+
+    /**
+     * @brief Lookup tables for destination blending a fixed color, indexed by framebuffer nibble
+     *
+     * A RGBA4444 pixel is stored as the bytes (g << 4 | r) and (a << 4 | b), so the low
+     * nibbles hold r and b, the high nibbles g and a. The second half of every table
+     * is used for the odd bytes.
+     */
+    struct BlendDstTables {
+        u8 low[32];
+        u8 high[32];
+    };
+
+    inline BlendDstTables makeBlendDstTables(const u16 color) {
+        const u8 r = color & 0xF, g = (color >> 4) & 0xF, b = (color >> 8) & 0xF, a = color >> 12;
+        BlendDstTables tables;
+
+        for (u8 v = 0; v < 16; ++v) {
+            tables.low[v]       = blendColor(v, r, a);
+            tables.low[v + 16]  = blendColor(v, b, a);
+            tables.high[v]      = blendColor(v, g, a);
+            tables.high[v + 16] = (a + (v * (0xF - a) / 0xF)) & 0xF;
+        }
+
+        return tables;
+    }
+
+    /**
+     * @brief Shortest run for which drawing through BlendDstTables beats blending every pixel on its own
+     */
+    constexpr s32 BlendDstTablesMinWidth = 16;
+
+    /**
+     * @brief Destination blends a fixed color over contiguous pixels through its tables
+     *
+     * @param pixels Framebuffer pixels
+     * @param count Number of pixels
+     * @param tables Tables of the color
+     */
+    inline void blendDstPixelsScalar(u16* pixels, const s32 count, const BlendDstTables& tables) {
+        for (s32 i = 0; i < count; ++i) {
+            const u16 p = pixels[i];
+            pixels[i] = tables.low[p & 0xF] | (tables.high[(p >> 4) & 0xF] << 4) |
+                        (tables.low[16 + ((p >> 8) & 0xF)] << 8) | (tables.high[16 + (p >> 12)] << 12);
+        }
+    }
+
+    /**
+     * @brief Draws glyph pixels, full coverage writes the color, partial coverage blends it like blendDst
+     *
+     * @param pixels Framebuffer pixels
+     * @param coverage 8 bit glyph coverage, only the upper 4 bits are used
+     * @param count Number of pixels
+     * @param color Text color
+     */
+    inline void blendCoveragePixelsScalar(u16* pixels, const u8* coverage, const s32 count, const u16 color) {
+        for (s32 i = 0; i < count; ++i) {
+            const u8 alpha = coverage[i] >> 4;
+            if (alpha == 0xF)
+                pixels[i] = color;
+            else if (alpha != 0x0)
+                pixels[i] = blendDst(pixels[i], (color & 0x0FFF) | (alpha << 12));
+        }
+    }
+
+#if defined(__ARM_NEON)
+    /**
+     * @brief NEON version of blendDstPixelsScalar for exactly 8 pixels, same result
+     *
+     * @param pixels Framebuffer pixels
+     * @param tables Tables of the color
+     */
+    inline void blendDstPixelsNeon(u16* pixels, const BlendDstTables& tables) {
+        static const u8 parityBytes[16] = { 0, 16, 0, 16, 0, 16, 0, 16, 0, 16, 0, 16, 0, 16, 0, 16 };
+        const uint8x16x2_t low = { { vld1q_u8(tables.low), vld1q_u8(tables.low + 16) } };
+        const uint8x16x2_t high = { { vld1q_u8(tables.high), vld1q_u8(tables.high + 16) } };
+        const uint8x16_t parity = vld1q_u8(parityBytes);
+
+        u8* bytes = reinterpret_cast<u8*>(pixels);
+        const uint8x16_t src = vld1q_u8(bytes);
+        const uint8x16_t lowIndex = vorrq_u8(vandq_u8(src, vdupq_n_u8(0xF)), parity);
+        const uint8x16_t highIndex = vorrq_u8(vshrq_n_u8(src, 4), parity);
+
+        vst1q_u8(bytes, vorrq_u8(vqtbl2q_u8(low, lowIndex), vshlq_n_u8(vqtbl2q_u8(high, highIndex), 4)));
+    }
+
+    /**
+     * @brief NEON version of blendCoveragePixelsScalar for exactly 8 pixels, same result
+     *
+     * @param pixels Framebuffer pixels
+     * @param coverage 8 bit glyph coverage, only the upper 4 bits are used
+     * @param color Text color
+     */
+    inline void blendCoveragePixelsNeon(u16* pixels, const u8* coverage, const u16 color) {
+        const uint8x8_t alpha = vshr_n_u8(vld1_u8(coverage), 4);
+        const uint8x8_t inverse = vsub_u8(vdup_n_u8(0xF), alpha);
+
+        const uint16x8_t dst = vld1q_u16(pixels);
+        const uint8x8_t dstR = vmovn_u16(vandq_u16(dst, vdupq_n_u16(0xF)));
+        const uint8x8_t dstG = vmovn_u16(vandq_u16(vshrq_n_u16(dst, 4), vdupq_n_u16(0xF)));
+        const uint8x8_t dstB = vmovn_u16(vandq_u16(vshrq_n_u16(dst, 8), vdupq_n_u16(0xF)));
+        const uint8x8_t dstA = vmovn_u16(vshrq_n_u16(dst, 12));
+
+        const uint8x8_t r = vshrn_n_u16(vmlal_u8(vmull_u8(vdup_n_u8(color & 0xF), alpha), dstR, inverse), 4);
+        const uint8x8_t g = vshrn_n_u16(vmlal_u8(vmull_u8(vdup_n_u8((color >> 4) & 0xF), alpha), dstG, inverse), 4);
+        const uint8x8_t b = vshrn_n_u16(vmlal_u8(vmull_u8(vdup_n_u8((color >> 8) & 0xF), alpha), dstB, inverse), 4);
+
+        // x / 15 for x <= 225 is (x + 1 + (x >> 4)) >> 4
+        const uint16x8_t scaled = vmull_u8(dstA, inverse);
+        const uint16x8_t quotient = vshrq_n_u16(vaddq_u16(vaddq_u16(scaled, vdupq_n_u16(1)), vshrq_n_u16(scaled, 4)), 4);
+        const uint16x8_t a = vandq_u16(vaddq_u16(vmovl_u8(alpha), quotient), vdupq_n_u16(0xF));
+
+        uint16x8_t out = vmovl_u8(r);
+        out = vorrq_u16(out, vshlq_n_u16(vmovl_u8(g), 4));
+        out = vorrq_u16(out, vshlq_n_u16(vmovl_u8(b), 8));
+        out = vorrq_u16(out, vshlq_n_u16(a, 12));
+
+        // Full coverage writes the color, no coverage keeps the pixel
+        const uint16x8_t alphaWide = vmovl_u8(alpha);
+        out = vbslq_u16(vceqq_u16(alphaWide, vdupq_n_u16(0xF)), vdupq_n_u16(color), out);
+        out = vbslq_u16(vceqq_u16(alphaWide, vdupq_n_u16(0x0)), dst, out);
+        vst1q_u16(pixels, out);
+    }
+#endif
+
+    /**
+     * @brief Destination blends a fixed color over up to 8 contiguous pixels, same result as blendDst
+     *
+     * @param pixels Framebuffer pixels
+     * @param count Number of pixels, 8 uses NEON
+     * @param tables Tables of the color
+     */
+    inline void blendDstPixels(u16* pixels, const s32 count, const BlendDstTables& tables) {
+    #if defined(__ARM_NEON)
+        if (count == 8)
+            return blendDstPixelsNeon(pixels, tables);
+    #endif
+        blendDstPixelsScalar(pixels, count, tables);
+    }
+
+    /**
+     * @brief Draws up to 8 glyph pixels, full coverage writes the color, partial coverage blends it like blendDst
+     *
+     * @param pixels Framebuffer pixels
+     * @param coverage 8 bit glyph coverage, only the upper 4 bits are used
+     * @param count Number of pixels, 8 uses NEON
+     * @param color Text color
+     */
+    inline void blendCoveragePixels(u16* pixels, const u8* coverage, const s32 count, const u16 color) {
+    #if defined(__ARM_NEON)
+        if (count == 8)
+            return blendCoveragePixelsNeon(pixels, coverage, color);
+    #endif
+        blendCoveragePixelsScalar(pixels, coverage, count, color);
+    }
+
+    /**
+     * @brief Part of the swizzled framebuffer offset that only depends on y
+     *
+     * @param y Y pos
+     * @return Offset
+     */
+    constexpr inline u32 getRowOffset(const s32 y) {
+        return (((y & 127) / 16) + ((y / 128) * 112))*512 +
+                ((y % 16) / 8) * 256 +
+                ((y % 8) / 2) * 32 +
+                (y % 2) * 8;
+    }
+
+    /**
+     * @brief Part of the swizzled framebuffer offset that only depends on x, pixels x to x | 7 are contiguous
+     *
+     * @param x X pos
+     * @return Offset
+     */
+    constexpr inline u32 getColumnOffset(const s32 x) {
+        return ((x / 32) * 8)*512 +
+                ((x % 32) / 16) * 128 +
+                ((x % 16) / 8) * 16 +
+                (x % 8);
+    }
+
+    /**
+     * @brief Clips a horizontal run against a rectangle
+     *
+     * @param x X start pos, raised to the rectangle
+     * @param x_end X pos past the run, lowered to the rectangle
+     * @param y Y pos
+     * @param clipX X pos of the rectangle
+     * @param clipY Y pos of the rectangle
+     * @param clipW Width of the rectangle
+     * @param clipH Height of the rectangle
+     * @return Whether any pixel of the run is left
+     */
+    constexpr inline bool clipSpan(s32& x, s32& x_end, const s32 y, const s32 clipX, const s32 clipY, const s32 clipW, const s32 clipH) {
+        if (y < clipY || y >= clipY + clipH)
+            return false;
+
+        x = std::max(x, clipX);
+        x_end = std::min(x_end, clipX + clipW);
+
+        return x < x_end;
+    }
+
+    /**
+     * @brief Calls func(pixels, x, count) for every contiguous group of an already clipped horizontal run
+     *
+     * Walks the block linear layout one group of up to 8 contiguous pixels at a time.
+     * Aligned groups inside the run hold exactly 8 pixels.
+     *
+     * @param framebuffer Swizzled framebuffer
+     * @param x X start pos
+     * @param x_end X pos past the run
+     * @param y Y pos
+     * @param func Group function, receives the first framebuffer pixel, its x pos and the pixel count
+     */
+    template<typename Func>
+    inline void forEachSpanGroup(u16* framebuffer, s32 x, const s32 x_end, const s32 y, Func&& func) {
+        u16* row = framebuffer + getRowOffset(y);
+
+        while (x < x_end) {
+            const s32 groupStart = x & ~7;
+            const s32 groupEnd = std::min(groupStart + 8, x_end);
+
+            func(row + getColumnOffset(groupStart) + (x & 7), x, groupEnd - x);
+            x = groupEnd;
+        }
+    }
+
+    /**
+     * @brief Area of the framebuffer in pixels
+     */
+    struct Rect {
+        s32 x, y, w, h;
+    };
+
+    /**
+     * @brief Bounding box of two areas, empty areas are ignored
+     */
+    constexpr inline Rect uniteRects(const Rect& first, const Rect& second) {
+        if (first.w <= 0 || first.h <= 0)
+            return second;
+        if (second.w <= 0 || second.h <= 0)
+            return first;
+
+        const s32 x = std::min(first.x, second.x);
+        const s32 y = std::min(first.y, second.y);
+        return { x, y, std::max(first.x + first.w, second.x + second.w) - x, std::max(first.y + first.h, second.y + second.h) - y };
+    }
+
+    /**
+     * @brief Damage tracking of the two swapchain framebuffers, used by Renderer::startDamagedFrame
+     *
+     * Marked areas are collected until the next frame starts. Each framebuffer then keeps
+     * the damage it has not been drawn with yet, because the two are drawn alternately.
+     */
+    class FrameDamage {
+    public:
+        /**
+         * @brief Frame counters of the damage tracking
+         */
+        struct Stats {
+            u64 frames;        ///< Frames that were drawn
+            u64 skippedFrames; ///< Frames without damage that were not drawn
+            u64 pixels;        ///< Pixels inside the damage of the drawn frames
+        };
+
+        /**
+         * @brief Marks an area to be redrawn by the next frames of both framebuffers
+         */
+        void mark(const Rect& rect) {
+            m_marked = uniteRects(m_marked, rect);
+        }
+
+        /**
+         * @brief Hands the marked areas to every framebuffer
+         *
+         * @return Whether any framebuffer has damage, otherwise the frame is counted as skipped
+         */
+        bool collect() {
+            bool damaged = false;
+            for (auto& damage : m_framebuffers) {
+                damage = uniteRects(damage, m_marked);
+                damaged |= damage.w > 0 && damage.h > 0;
+            }
+            m_marked = { 0, 0, 0, 0 };
+
+            if (!damaged)
+                m_stats.skippedFrames++;
+
+            return damaged;
+        }
+
+        /**
+         * @brief Takes the damage of the framebuffer that gets drawn, clipped to the screen
+         *
+         * @param slot Swapchain slot of the framebuffer
+         * @param width Framebuffer width
+         * @param height Framebuffer height
+         * @return Area to redraw, empty if the framebuffer is already up to date, which is counted as a skipped frame
+         */
+        Rect take(const u32 slot, const s32 width, const s32 height) {
+            auto& damage = m_framebuffers[slot % m_framebuffers.size()];
+            const s32 x = std::max(damage.x, 0);
+            const s32 y = std::max(damage.y, 0);
+            const s32 x_end = std::min(damage.x + damage.w, width);
+            const s32 y_end = std::min(damage.y + damage.h, height);
+            const Rect clip = { x, y, std::max(x_end - x, 0), std::max(y_end - y, 0) };
+            damage = { 0, 0, 0, 0 };
+
+            if (clip.w == 0 || clip.h == 0) {
+                m_stats.skippedFrames++;
+            } else {
+                m_stats.frames++;
+                m_stats.pixels += clip.w * clip.h;
+            }
+
+            return clip;
+        }
+
+        const Stats& stats() const {
+            return m_stats;
+        }
+
+    private:
+        std::array<Rect, 2> m_framebuffers = {};
+        Rect m_marked = { 0, 0, 0, 0 };
+        Stats m_stats = {};
+    };
+
+    /**
+     * @brief Persistent renderer worker threads, started once by Renderer::init
+     *
+     * Jobs are split into row bands which are handed out through an atomic counter.
+     * The calling thread works on bands as well, so threads - 1 workers are spawned.
+     * Two reusable barriers mark the start and the end of every job.
+     */
+    class RenderWorkers {
+    public:
+        /**
+         * @param threads Threads working on a job including the caller, below 2 runs jobs on the caller only
+         */
+        explicit RenderWorkers(const unsigned threads) : m_threads(threads), m_startBarrier(threads ? threads : 1), m_doneBarrier(threads ? threads : 1) {}
+
+        RenderWorkers(const RenderWorkers&) = delete;
+        RenderWorkers& operator=(const RenderWorkers&) = delete;
+
+        ~RenderWorkers() {
+            this->stop();
+        }
+
+        void start() {
+            if (m_threads < 2 || !m_workers.empty())
+                return;
+
+            m_workers.reserve(m_threads - 1);
+            for (unsigned i = 0; i < m_threads - 1; ++i)
+                m_workers.emplace_back(&RenderWorkers::workerLoop, this);
+        }
+
+        void stop() {
+            if (m_workers.empty())
+                return;
+
+            m_stopping = true;
+            m_startBarrier.arrive_and_wait();
+
+            for (auto& worker : m_workers)
+                worker.join();
+
+            m_workers.clear();
+            m_stopping = false;
+        }
+
+        /**
+         * @brief Calls func(startRow, endRow) for every band of rows in [begin, end) and returns once all are done
+         *
+         * @param begin First row
+         * @param end Row past the last one
+         * @param bandRows Rows per band
+         * @param func Band function, called concurrently from all workers
+         */
+        template<typename F>
+        void run(s32 begin, s32 end, s32 bandRows, F& func) {
+            if (m_workers.empty()) {
+                func(begin, end);
+                return;
+            }
+
+            m_context = &func;
+            m_job = [](void* context, s32 startRow, s32 endRow) { (*static_cast<F*>(context))(startRow, endRow); };
+            m_end = end;
+            m_bandRows = bandRows;
+            m_nextRow.store(begin, std::memory_order_relaxed);
+
+            m_startBarrier.arrive_and_wait();
+            processBands();
+            m_doneBarrier.arrive_and_wait();
+        }
+
+    private:
+        void processBands() {
+            while (true) {
+                const s32 startRow = m_nextRow.fetch_add(m_bandRows, std::memory_order_relaxed);
+                if (startRow >= m_end)
+                    break;
+
+                m_job(m_context, startRow, std::min(startRow + m_bandRows, m_end));
+            }
+        }
+
+        void workerLoop() {
+            while (true) {
+                m_startBarrier.arrive_and_wait();
+                if (m_stopping)
+                    return;
+
+                processBands();
+                m_doneBarrier.arrive_and_wait();
+            }
+        }
+
+        const unsigned m_threads;
+        std::vector<std::thread> m_workers;
+        std::barrier<> m_startBarrier;
+        std::barrier<> m_doneBarrier;
+        std::atomic<s32> m_nextRow{0};
+        void (*m_job)(void*, s32, s32) = nullptr;
+        void* m_context = nullptr;
+        s32 m_end = 0;
+        s32 m_bandRows = 1;
+        bool m_stopping = false;
+    };
+
+}
@@ -14,90 +14,283 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #define TESLA_INIT_IMPL
+#include <actions.hpp>
 #include <payload.hpp>
 #include <util.hpp>
 
 #include <tesla.hpp>
 
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
 namespace {
 
     constexpr const char AppTitle[] = APP_TITLE;
     constexpr const char AppVersion[] = APP_VERSION;
 
+#ifdef QRB_PROFILE
+    /**
+     * @brief Formatiert die Zähler der Damage-Verfolgung des Renderers.
+     * @return Gezeichnete und übersprungene Frames sowie der Anteil neu gezeichneter Pixel.
+     */
+    std::string FormatFrameStats() {
+        auto const &stats = tsl::gfx::Renderer::getFrameStats();
+        u64 const full = stats.frames * tsl::cfg::FramebufferWidth * tsl::cfg::FramebufferHeight;
+
+        char buffer[0x40];
+        std::snprintf(buffer, sizeof(buffer), "%llu frames | %llu skipped | %llu%% px", static_cast<unsigned long long>(stats.frames),
+                      static_cast<unsigned long long>(stats.skippedFrames), static_cast<unsigned long long>(full ? stats.pixels * 100 / full : 0));
+        return buffer;
+    }
+#endif
+
 }
 
 /**
- * @brief Klasse für die GUI des Pancake-Overlays.
+ * @brief Listeneintrag einer Hekate-Konfiguration, lädt deren Metadaten erst beim ersten Fokus.
  */
-class PancakeGui : public tsl::Gui {
+class HekateConfigListItem final : public tsl::elm::ListItem {
   private:
-    Payload::HekateConfigList const boot_config_list; ///< Liste der Boot-Konfigurationen.
-    Payload::HekateConfigList const ini_config_list; ///< Liste der INI-Konfigurationen.
-    Payload::PayloadConfigList const payload_config_list; ///< Liste der Payload-Konfigurationen.
+    Payload::HekateConfig const &config; ///< Zugehörige Konfiguration.
+    bool decoded = false; ///< Ob die Metadaten bereits geladen wurden.
 
   public:
     /**
-     * @brief Konstruktor, lädt die Konfigurationslisten.
+     * @brief Konstruktor.
+     * @param config Zugehörige Konfiguration.
      */
-    PancakeGui()
-        : boot_config_list(Payload::LoadHekateConfigList()),
-          ini_config_list(Payload::LoadIniConfigList()),
-          payload_config_list(Payload::LoadPayloadList()) {
+    explicit HekateConfigListItem(Payload::HekateConfig const &config)
+        : ListItem(std::string(config.name)), config(config) {
     }
 
     /**
-     * @brief Erstellt die Benutzeroberfläche.
-     * @return Zeiger auf das erstellte UI-Element.
+     * @brief Zeigt beim ersten Fokus die Art des Eintrags (emuMMC, sysMMC, payload) an.
+     * @param state Neuer Fokuszustand.
      */
-    virtual tsl::elm::Element *createUI() override {
-        auto const frame = new tsl::elm::OverlayFrame(AppTitle, AppVersion);
+    virtual void setFocused(bool state) override {
+        if (state && !decoded) {
+            decoded = true;
+
+            auto const tag = config.Metadata().Tag();
+            if (!tag.empty())
+                setValue(std::string(tag), true);
+        }
+
+        ListItem::setFocused(state);
+    }
+};
+
+/**
+ * @brief Lädt die Konfigurationslisten im Hintergrund, gehört dem Overlay.
+ *
+ * Der Thread nutzt fsdev, spl und bpc:ams und muss daher vor dem Beenden der Dienste
+ * gestoppt werden, nicht erst beim Zerstören der GUI.
+ */
+class ConfigScanner {
+  private:
+    Payload::BootConfigs configs; ///< Boot- und INI-Konfigurationen, gültig sobald configs_ready gesetzt ist.
+    Payload::PayloadConfigList payload_config_list; ///< Liste der Payload-Konfigurationen, gültig sobald payloads_ready gesetzt ist.
+    util::StageProfile profile; ///< Laufzeiten der einzelnen Ladevorgänge.
+
+    std::atomic<bool> configs_ready = false; ///< Boot- und INI-Konfigurationen wurden geladen.
+    std::atomic<bool> payloads_ready = false; ///< Payloads wurden geladen.
+
+    std::thread thread; ///< Hintergrund-Thread, läuft von Start() bis Join().
+
+    /**
+     * @brief Lädt die Konfigurationslisten, läuft im Hintergrund-Thread.
+     */
+    void Scan() {
+        configs = Payload::LoadBootConfigs();
+        profile.Mark("configs", configs.boot.size() + configs.ini.size());
+        configs_ready.store(true, std::memory_order_release);
+
+        Payload::PreloadHekatePayload();
+        profile.Mark("hekate", 1);
+
+        payload_config_list = Payload::LoadPayloadList();
+        profile.Mark("payloads", payload_config_list.size());
+        payloads_ready.store(true, std::memory_order_release);
+    }
+
+  public:
+    /**
+     * @brief Destruktor, wartet auf das Ende des Ladevorgangs.
+     */
+    ~ConfigScanner() {
+        Join();
+    }
+
+    /**
+     * @brief Startet das Laden, die Dienste müssen bereits initialisiert sein.
+     */
+    void Start() {
+        thread = std::thread(&ConfigScanner::Scan, this);
+    }
+
+    /**
+     * @brief Wartet auf das Ende des Ladevorgangs, mehrfacher Aufruf ist erlaubt.
+     */
+    void Join() {
+        if (thread.joinable())
+            thread.join();
+    }
+
+    /**
+     * @brief Boot- und INI-Konfigurationen.
+     * @return Zeiger auf die Konfigurationen oder nullptr, solange sie noch geladen werden.
+     */
+    Payload::BootConfigs const *Configs() const {
+        return configs_ready.load(std::memory_order_acquire) ? &configs : nullptr;
+    }
+
+    /**
+     * @brief Payload-Konfigurationen.
+     * @return Zeiger auf die Liste oder nullptr, solange sie noch geladen wird.
+     */
+    Payload::PayloadConfigList const *Payloads() const {
+        return payloads_ready.load(std::memory_order_acquire) ? &payload_config_list : nullptr;
+    }
+
+    /**
+     * @brief Laufzeiten der Ladevorgänge, vollständig sobald Payloads() verfügbar ist.
+     * @return Profil der Ladevorgänge.
+     */
+    util::StageProfile const &Profile() const {
+        return profile;
+    }
+};
+
+/**
+ * @brief Klasse für die GUI des Pancake-Overlays.
+ */
+class PancakeGui : public tsl::Gui {
+  private:
+    ConfigScanner const &scanner; ///< Lädt die Konfigurationslisten, gehört dem Overlay.
+    bool configs_shown = false; ///< Boot- und INI-Einträge wurden zur Liste hinzugefügt.
+    bool payloads_shown = false; ///< Payload-Einträge wurden zur Liste hinzugefügt.
 
-        auto const list = new tsl::elm::List();
+    tsl::elm::List *list = nullptr; ///< Liste, in die die geladenen Einträge eingefügt werden.
+#ifdef QRB_PROFILE
+    tsl::elm::CategoryHeader *frame_stats = nullptr; ///< Zeigt die Zähler der Damage-Verfolgung an.
+    util::Stopwatch frame_stats_age; ///< Zeit seit der letzten Aktualisierung der Zähler.
+#endif
+
+    /**
+     * @brief Fügt die Boot- und INI-Einträge ganz oben in die Liste ein.
+     *
+     * Die Einträge stehen damit vor allem, was schon in der Liste ist. Payloads
+     * hängt AddPayloadItems dagegen ans Ende an.
+     * @param configs Geladene Konfigurationen.
+     */
+    void AddConfigItems(Payload::BootConfigs const &configs) {
+        ssize_t index = 0;
 
         /* Boot-Konfigurationseinträge hinzufügen. */
-        if (!boot_config_list.empty()) {
-            list->addItem(new tsl::elm::CategoryHeader("quickReLoad to..."));
+        if (!configs.boot.empty()) {
+            list->addItem(new tsl::elm::CategoryHeader("quickReLoad to..."), 0, index++);
 
-            for (auto const &config : boot_config_list) {
-                auto const entry = new tsl::elm::ListItem(config.name);
+            for (auto const &config : configs.boot) {
+                auto const entry = new HekateConfigListItem(config);
                 entry->setClickListener([&](u64 const keys) -> bool { return (keys & HidNpadButton_A) && Payload::RebootToHekateConfig(config, false); });
-                list->addItem(entry);
+                list->addItem(entry, 0, index++);
             }
         }
 
         /* INI-Konfigurationseinträge hinzufügen. */
-        if (!ini_config_list.empty()) {
-            list->addItem(new tsl::elm::CategoryHeader("more reLoads"));
+        if (!configs.ini.empty()) {
+            list->addItem(new tsl::elm::CategoryHeader("more reLoads"), 0, index++);
 
-            for (auto const &config : ini_config_list) {
-                auto const entry = new tsl::elm::ListItem(config.name);
+            for (auto const &config : configs.ini) {
+                auto const entry = new HekateConfigListItem(config);
                 entry->setClickListener([&](u64 const keys) -> bool { return (keys & HidNpadButton_A) && Payload::RebootToHekateConfig(config, true); });
-                list->addItem(entry);
+                list->addItem(entry, 0, index++);
             }
         }
+    }
 
-        /* Verschiedenes. */
-        list->addItem(new tsl::elm::CategoryHeader("other Stuff"));
-
-        auto const ums = new tsl::elm::ListItem("SD <-UMS-> PC");
-        ums->setClickListener([](u64 const keys) -> bool { return (keys & HidNpadButton_A) && Payload::RebootToHekateUMS(Payload::UmsTarget_Sd); });
-        list->addItem(ums);
-
-        /* Payloads */
+    /**
+     * @brief Hängt die Payload-Einträge an das Ende der Liste an.
+     * @param payload_config_list Geladene Payload-Konfigurationen.
+     */
+    void AddPayloadItems(Payload::PayloadConfigList const &payload_config_list) {
         if (util::IsErista() && !payload_config_list.empty()) {
             list->addItem(new tsl::elm::CategoryHeader("payloads"));
 
             for (auto const &config : payload_config_list) {
-                auto const entry = new tsl::elm::ListItem(config.name);
+                auto const entry = new tsl::elm::ListItem(std::string(config.name), config.valid ? "" : "invalid");
                 entry->setClickListener([&](u64 const keys) -> bool { return (keys & HidNpadButton_A) && Payload::RebootToPayload(config); });
                 list->addItem(entry);
             }
         }
 
+#ifdef QRB_PROFILE
+        list->addItem(new tsl::elm::CategoryHeader(scanner.Profile().Format()));
+
+        frame_stats = new tsl::elm::CategoryHeader(FormatFrameStats());
+        list->addItem(frame_stats);
+#endif
+    }
+
+  public:
+    /**
+     * @brief Konstruktor.
+     * @param scanner Bereits gestarteter Ladevorgang der Konfigurationslisten.
+     */
+    explicit PancakeGui(ConfigScanner const &scanner) : scanner(scanner) {
+    }
+
+    /**
+     * @brief Erstellt die Benutzeroberfläche mit den sofort verfügbaren Einträgen.
+     * @return Zeiger auf das erstellte UI-Element.
+     */
+    virtual tsl::elm::Element *createUI() override {
+        auto const frame = new tsl::elm::OverlayFrame(AppTitle, AppVersion);
+
+        list = new tsl::elm::List();
+
+        /* Feste Aktionen aus der gemeinsamen Tabelle. */
+        for (auto const &group : Payload::ActionGroups()) {
+            list->addItem(new tsl::elm::CategoryHeader(std::string(group.name)));
+
+            for (auto const &action : group.actions) {
+                if (!action.Available())
+                    continue;
+
+                auto const entry = new tsl::elm::ListItem(std::string(action.name));
+                entry->setClickListener([&action](u64 const keys) -> bool { return (keys & HidNpadButton_A) && Payload::Reboot(action.request); });
+                list->addItem(entry);
+            }
+        }
+
         frame->setContent(list);
         return frame;
     }
 
+    /**
+     * @brief Fügt fertig geladene Abschnitte zur Liste hinzu, wird jeden Frame aufgerufen.
+     */
+    virtual void update() override {
+        if (auto const configs = scanner.Configs(); !configs_shown && configs != nullptr) {
+            configs_shown = true;
+            AddConfigItems(*configs);
+        }
+
+        if (auto const payloads = scanner.Payloads(); !payloads_shown && payloads != nullptr) {
+            payloads_shown = true;
+            AddPayloadItems(*payloads);
+        }
+
+#ifdef QRB_PROFILE
+        /* Nur einmal pro Sekunde, damit die Anzeige selbst kaum neue Frames auslöst. */
+        if (frame_stats != nullptr && frame_stats_age.ElapsedUs() >= 1'000'000) {
+            frame_stats->setText(FormatFrameStats());
+            frame_stats_age.Reset();
+        }
+#endif
+    }
+
     /**
      * @brief Behandelt Benutzereingaben.
      * @param keysDown Gedrückte Tasten.
@@ -150,6 +343,9 @@ class PleaseUpdateGui final : public tsl::Gui {
  * @brief Overlay-Klasse für das Pancake-Overlay.
  */
 class PancakeOverlay final : public tsl::Overlay {
+  private:
+    ConfigScanner scanner; ///< Lädt die Konfigurationslisten für die PancakeGui.
+
   public:
     /**
      * @brief Initialisiert die benötigten Dienste.
@@ -159,12 +355,20 @@ class PancakeOverlay final : public tsl::Overlay {
         splInitialize();
         spsmInitialize();
         i2cInitialize();
+
+        /* setsys wurde bereits von libtesla initialisiert. */
+        /* bpc:ams verbindet erst der Ladethread, nicht der UI-Thread beim Start. */
+        util::ProbeCapabilities();
     }
 
     /**
      * @brief Beendet die initialisierten Dienste.
      */
     virtual void exitServices() override {
+        /* Der Ladevorgang nutzt noch die Dienste. */
+        scanner.Join();
+
+        Payload::ClosePreloadSession();
         i2cExit();
         spsmExit();
         splExit();
@@ -179,7 +383,8 @@ class PancakeOverlay final : public tsl::Overlay {
         if (!util::IsErista() && !util::SupportsMarikoRebootToConfig()) {
             return std::make_unique<PleaseUpdateGui>();
         } else {
-            return std::make_unique<PancakeGui>();
+            scanner.Start();
+            return std::make_unique<PancakeGui>(scanner);
         }
     }
 };